@@ -0,0 +1,618 @@
+// Baseline benchmark for libdbus and the daemon. It does not load or call any
+// extension code: it starts a private dbus-daemon in a temporary directory,
+// runs an echo service on its own connection and measures method call round
+// trips, signal throughput and the cost of encoding and decoding
+// representative payloads with plain libdbus. The extension itself is measured
+// by bench/extension_bench.gd, and the difference between the two is the
+// overhead of the extension. Results are written as JSON so that runs can be
+// compared.
+//
+// Usage: dbus_bench [--scale N] [--output FILE]
+//
+// The daemon binary can be overridden with the DBUS_DAEMON environment
+// variable.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dbus/dbus.h>
+#include <signal.h>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const char *SERVICE_NAME = "org.godot.DBusBench";
+static const char *SERVICE_PATH = "/org/godot/DBusBench";
+static const char *SERVICE_IFACE = "org.godot.DBusBench";
+
+// Returns a monotonic timestamp in microseconds
+static uint64_t now_usec() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Returns the given percentile of the (unsorted) samples
+static double percentile(std::vector<double> samples, double pct) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  std::sort(samples.begin(), samples.end());
+  size_t index = (size_t)(pct / 100.0 * (samples.size() - 1) + 0.5);
+  return samples[std::min(index, samples.size() - 1)];
+}
+
+// Returns the mean of the samples
+static double mean(const std::vector<double> &samples) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  double total = 0.0;
+  for (double sample : samples) {
+    total += sample;
+  }
+  return total / samples.size();
+}
+
+// Prints the error and exits
+static void fail(const char *what, DBusError *error) {
+  fprintf(stderr, "dbus_bench: %s: %s\n", what,
+          error != nullptr && dbus_error_is_set(error) ? error->message
+                                                       : "failed");
+  exit(1);
+}
+
+// A dbus-daemon running in a temporary directory
+struct BenchDaemon {
+  pid_t pid = -1;
+  std::string dir;
+  std::string address;
+
+  // Starts the daemon and waits for it to print its address
+  void start() {
+    char dir_template[] = "/tmp/godot-dbus-bench.XXXXXX";
+    if (mkdtemp(dir_template) == nullptr) {
+      fail("unable to create temporary directory", nullptr);
+    }
+    dir = dir_template;
+    std::string listen = "--address=unix:path=" + dir + "/bus";
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+      fail("unable to create pipe", nullptr);
+    }
+    const char *daemon = getenv("DBUS_DAEMON");
+    if (daemon == nullptr) {
+      daemon = "dbus-daemon";
+    }
+
+    pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      std::string print_address = "--print-address=" + std::to_string(fds[1]);
+      execlp(daemon, daemon, "--session", "--nofork", "--nopidfile",
+             listen.c_str(), print_address.c_str(), (char *)nullptr);
+      _exit(127);
+    }
+    close(fds[1]);
+
+    char buffer[512];
+    ssize_t total = 0;
+    ssize_t count;
+    while ((count = read(fds[0], buffer + total, sizeof(buffer) - 1 - total)) >
+           0) {
+      total += count;
+      if (memchr(buffer, '\n', total) != nullptr) {
+        break;
+      }
+    }
+    close(fds[0]);
+    buffer[total] = '\0';
+    char *newline = strchr(buffer, '\n');
+    if (newline == nullptr) {
+      fail("dbus-daemon did not print its address", nullptr);
+    }
+    *newline = '\0';
+    address = buffer;
+  }
+
+  // Stops the daemon and removes the temporary directory
+  void stop() {
+    if (pid > 0) {
+      kill(pid, SIGTERM);
+      waitpid(pid, nullptr, 0);
+      pid = -1;
+    }
+    if (!dir.empty()) {
+      unlink((dir + "/bus").c_str());
+      rmdir(dir.c_str());
+    }
+  }
+};
+
+// Opens a private connection to the bus at the given address
+static DBusConnection *open_bus(const std::string &address) {
+  DBusError error;
+  dbus_error_init(&error);
+  DBusConnection *conn =
+      dbus_connection_open_private(address.c_str(), &error);
+  if (conn == nullptr) {
+    fail("unable to connect", &error);
+  }
+  if (!dbus_bus_register(conn, &error)) {
+    fail("unable to register with the bus", &error);
+  }
+  dbus_connection_set_exit_on_disconnect(conn, false);
+  return conn;
+}
+
+// Copies the value at "src" to "dst", recursing into containers
+static void copy_arg(DBusMessageIter *src, DBusMessageIter *dst) {
+  int type = dbus_message_iter_get_arg_type(src);
+  if (!dbus_type_is_container(type)) {
+    DBusBasicValue value;
+    dbus_message_iter_get_basic(src, &value);
+    dbus_message_iter_append_basic(dst, type, &value);
+    return;
+  }
+
+  DBusMessageIter src_sub;
+  DBusMessageIter dst_sub;
+  dbus_message_iter_recurse(src, &src_sub);
+  char *signature = nullptr;
+  if (type == DBUS_TYPE_VARIANT || type == DBUS_TYPE_ARRAY) {
+    signature = dbus_message_iter_get_signature(&src_sub);
+  }
+
+  // Fixed size arrays are copied in one go
+  int element_type = type == DBUS_TYPE_ARRAY
+                         ? dbus_message_iter_get_element_type(src)
+                         : DBUS_TYPE_INVALID;
+  dbus_message_iter_open_container(dst, type, signature, &dst_sub);
+  if (type == DBUS_TYPE_ARRAY && dbus_type_is_fixed(element_type) &&
+      element_type != DBUS_TYPE_UNIX_FD) {
+    const void *data = nullptr;
+    int count = 0;
+    dbus_message_iter_get_fixed_array(&src_sub, &data, &count);
+    dbus_message_iter_append_fixed_array(&dst_sub, element_type, &data, count);
+  } else {
+    while (dbus_message_iter_get_arg_type(&src_sub) != DBUS_TYPE_INVALID) {
+      copy_arg(&src_sub, &dst_sub);
+      dbus_message_iter_next(&src_sub);
+    }
+  }
+  dbus_message_iter_close_container(dst, &dst_sub);
+  dbus_free(signature);
+}
+
+// Echo service answering on its own connection and thread:
+// - Ping() returns nothing
+// - Echo(...) returns its arguments
+// - Emit(u count) emits "count" Tick(u) signals, then returns
+struct EchoService {
+  DBusConnection *conn = nullptr;
+  std::thread thread;
+  std::atomic<bool> running{false};
+
+  // Handles a single method call
+  void handle(DBusMessage *msg) {
+    DBusMessage *reply = dbus_message_new_method_return(msg);
+    if (dbus_message_is_method_call(msg, SERVICE_IFACE, "Echo")) {
+      DBusMessageIter src;
+      DBusMessageIter dst;
+      dbus_message_iter_init_append(reply, &dst);
+      if (dbus_message_iter_init(msg, &src)) {
+        do {
+          copy_arg(&src, &dst);
+        } while (dbus_message_iter_next(&src));
+      }
+    } else if (dbus_message_is_method_call(msg, SERVICE_IFACE, "Emit")) {
+      dbus_uint32_t count = 0;
+      dbus_message_get_args(msg, nullptr, DBUS_TYPE_UINT32, &count,
+                            DBUS_TYPE_INVALID);
+      for (dbus_uint32_t i = 0; i < count; i++) {
+        DBusMessage *tick =
+            dbus_message_new_signal(SERVICE_PATH, SERVICE_IFACE, "Tick");
+        dbus_message_append_args(tick, DBUS_TYPE_UINT32, &i,
+                                 DBUS_TYPE_INVALID);
+        dbus_connection_send(conn, tick, nullptr);
+        dbus_message_unref(tick);
+      }
+    } else if (!dbus_message_is_method_call(msg, SERVICE_IFACE, "Ping")) {
+      dbus_message_unref(reply);
+      reply = dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_METHOD,
+                                     "No such method");
+    }
+    dbus_connection_send(conn, reply, nullptr);
+    dbus_message_unref(reply);
+  }
+
+  // Serves calls until stopped
+  void loop() {
+    while (running) {
+      dbus_connection_read_write(conn, 50);
+      DBusMessage *msg;
+      while ((msg = dbus_connection_pop_message(conn)) != nullptr) {
+        if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_METHOD_CALL) {
+          handle(msg);
+        }
+        dbus_message_unref(msg);
+      }
+      dbus_connection_flush(conn);
+    }
+  }
+
+  // Connects, takes the service name and starts serving
+  void start(const std::string &address) {
+    conn = open_bus(address);
+    DBusError error;
+    dbus_error_init(&error);
+    int ret = dbus_bus_request_name(conn, SERVICE_NAME,
+                                    DBUS_NAME_FLAG_DO_NOT_QUEUE, &error);
+    if (ret != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+      fail("unable to own the service name", &error);
+    }
+    running = true;
+    thread = std::thread(&EchoService::loop, this);
+  }
+
+  // Stops serving and closes the connection
+  void stop() {
+    running = false;
+    if (thread.joinable()) {
+      thread.join();
+    }
+    dbus_connection_close(conn);
+    dbus_connection_unref(conn);
+  }
+};
+
+// Returns a new call to the given method of the echo service
+static DBusMessage *new_call(const char *method) {
+  return dbus_message_new_method_call(SERVICE_NAME, SERVICE_PATH,
+                                      SERVICE_IFACE, method);
+}
+
+// Appends a string key and a variant value to an open dictionary
+static void append_sv_entry(DBusMessageIter *dict, const char *key, int type,
+                            const void *value) {
+  char signature[2] = {(char)type, '\0'};
+  DBusMessageIter entry;
+  DBusMessageIter variant;
+  dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, nullptr,
+                                   &entry);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+  dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, signature,
+                                   &variant);
+  dbus_message_iter_append_basic(&variant, type, value);
+  dbus_message_iter_close_container(&entry, &variant);
+  dbus_message_iter_close_container(dict, &entry);
+}
+
+// Appends a property dictionary like the ones of a BlueZ device
+static void append_properties(DBusMessageIter *iter, int seed) {
+  DBusMessageIter dict;
+  dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+  const char *address = "11:22:33:44:55:66";
+  const char *name = "Controller";
+  const char *icon = "input-gaming";
+  dbus_bool_t flag = seed % 2;
+  dbus_int16_t rssi = -40 - seed % 50;
+  dbus_uint32_t klass = 0x2508;
+  dbus_uint16_t appearance = 0x03c4;
+  const char *adapter = "/org/bluez/hci0";
+  append_sv_entry(&dict, "Address", DBUS_TYPE_STRING, &address);
+  append_sv_entry(&dict, "Name", DBUS_TYPE_STRING, &name);
+  append_sv_entry(&dict, "Icon", DBUS_TYPE_STRING, &icon);
+  append_sv_entry(&dict, "Class", DBUS_TYPE_UINT32, &klass);
+  append_sv_entry(&dict, "Appearance", DBUS_TYPE_UINT16, &appearance);
+  append_sv_entry(&dict, "Paired", DBUS_TYPE_BOOLEAN, &flag);
+  append_sv_entry(&dict, "Connected", DBUS_TYPE_BOOLEAN, &flag);
+  append_sv_entry(&dict, "RSSI", DBUS_TYPE_INT16, &rssi);
+  append_sv_entry(&dict, "Adapter", DBUS_TYPE_OBJECT_PATH, &adapter);
+  dbus_message_iter_close_container(iter, &dict);
+}
+
+// Builds an Echo call with a single a{sv}
+static DBusMessage *build_asv() {
+  DBusMessage *msg = new_call("Echo");
+  DBusMessageIter iter;
+  dbus_message_iter_init_append(msg, &iter);
+  append_properties(&iter, 0);
+  return msg;
+}
+
+// Builds an Echo call with an a{oa{sa{sv}}} shaped like a GetManagedObjects
+// reply of 64 objects with 3 interfaces each
+static DBusMessage *build_managed_objects() {
+  static const char *IFACES[] = {"org.bluez.Device1",
+                                 "org.bluez.Battery1",
+                                 "org.freedesktop.DBus.Properties"};
+  DBusMessage *msg = new_call("Echo");
+  DBusMessageIter iter;
+  DBusMessageIter objects;
+  dbus_message_iter_init_append(msg, &iter);
+  dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{oa{sa{sv}}}",
+                                   &objects);
+  for (int i = 0; i < 64; i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "/org/bluez/hci0/dev_%02X", i);
+    const char *path_ptr = path;
+    DBusMessageIter object;
+    DBusMessageIter ifaces;
+    dbus_message_iter_open_container(&objects, DBUS_TYPE_DICT_ENTRY, nullptr,
+                                     &object);
+    dbus_message_iter_append_basic(&object, DBUS_TYPE_OBJECT_PATH, &path_ptr);
+    dbus_message_iter_open_container(&object, DBUS_TYPE_ARRAY, "{sa{sv}}",
+                                     &ifaces);
+    for (const char *iface : IFACES) {
+      DBusMessageIter entry;
+      dbus_message_iter_open_container(&ifaces, DBUS_TYPE_DICT_ENTRY, nullptr,
+                                       &entry);
+      dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &iface);
+      append_properties(&entry, i);
+      dbus_message_iter_close_container(&ifaces, &entry);
+    }
+    dbus_message_iter_close_container(&object, &ifaces);
+    dbus_message_iter_close_container(&objects, &object);
+  }
+  dbus_message_iter_close_container(&iter, &objects);
+  return msg;
+}
+
+// Builds an Echo call with a 1 MiB byte array
+static DBusMessage *build_bytes() {
+  std::vector<uint8_t> bytes(1024 * 1024);
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = (uint8_t)(i * 31);
+  }
+  DBusMessage *msg = new_call("Echo");
+  DBusMessageIter iter;
+  DBusMessageIter array;
+  const uint8_t *data = bytes.data();
+  dbus_message_iter_init_append(msg, &iter);
+  dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "y", &array);
+  dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE, &data,
+                                       (int)bytes.size());
+  dbus_message_iter_close_container(&iter, &array);
+  return msg;
+}
+
+// Visits every value in the container at the iterator the same way the
+// extension does when decoding, returning the number of values visited
+static uint64_t walk_arg(DBusMessageIter *iter) {
+  int type = dbus_message_iter_get_arg_type(iter);
+  if (!dbus_type_is_container(type)) {
+    DBusBasicValue value;
+    dbus_message_iter_get_basic(iter, &value);
+    if (type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH ||
+        type == DBUS_TYPE_SIGNATURE) {
+      // Account for converting the string
+      volatile size_t length = strlen(value.str);
+      (void)length;
+    }
+    return 1;
+  }
+
+  DBusMessageIter sub;
+  dbus_message_iter_recurse(iter, &sub);
+  if (type == DBUS_TYPE_ARRAY &&
+      dbus_type_is_fixed(dbus_message_iter_get_element_type(iter))) {
+    const void *data = nullptr;
+    int count = 0;
+    dbus_message_iter_get_fixed_array(&sub, &data, &count);
+    return 1;
+  }
+  uint64_t visited = 1;
+  while (dbus_message_iter_get_arg_type(&sub) != DBUS_TYPE_INVALID) {
+    visited += walk_arg(&sub);
+    dbus_message_iter_next(&sub);
+  }
+  return visited;
+}
+
+// Walks every argument of the message
+static uint64_t walk_message(DBusMessage *msg) {
+  uint64_t visited = 0;
+  DBusMessageIter iter;
+  if (dbus_message_iter_init(msg, &iter)) {
+    do {
+      visited += walk_arg(&iter);
+    } while (dbus_message_iter_next(&iter));
+  }
+  return visited;
+}
+
+// Sends the call and blocks for the reply, failing on errors
+static DBusMessage *call(DBusConnection *conn, DBusMessage *msg) {
+  DBusError error;
+  dbus_error_init(&error);
+  DBusMessage *reply =
+      dbus_connection_send_with_reply_and_block(conn, msg, 25000, &error);
+  if (reply == nullptr) {
+    fail("call failed", &error);
+  }
+  return reply;
+}
+
+// Measures round trips of an argument-less call
+static std::string bench_ping(DBusConnection *conn, int iterations) {
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  DBusMessage *msg = new_call("Ping");
+  uint64_t start = now_usec();
+  for (int i = 0; i < iterations; i++) {
+    uint64_t begin = now_usec();
+    DBusMessage *reply = call(conn, msg);
+    samples.push_back((double)(now_usec() - begin));
+    dbus_message_unref(reply);
+  }
+  double elapsed = (now_usec() - start) / 1e6;
+  dbus_message_unref(msg);
+
+  char json[512];
+  snprintf(json, sizeof(json),
+           "{\"calls\": %d, \"calls_per_sec\": %.1f, \"p50_usec\": %.1f, "
+           "\"p99_usec\": %.1f}",
+           iterations, iterations / elapsed, percentile(samples, 50),
+           percentile(samples, 99));
+  return json;
+}
+
+// Measures how fast signals can be received and popped
+static std::string bench_signals(DBusConnection *conn, int count) {
+  DBusError error;
+  dbus_error_init(&error);
+  std::string rule = std::string("type='signal',interface='") + SERVICE_IFACE +
+                     "',member='Tick'";
+  dbus_bus_add_match(conn, rule.c_str(), &error);
+  if (dbus_error_is_set(&error)) {
+    fail("unable to add match", &error);
+  }
+
+  DBusMessage *msg = new_call("Emit");
+  dbus_uint32_t n = count;
+  dbus_message_append_args(msg, DBUS_TYPE_UINT32, &n, DBUS_TYPE_INVALID);
+  uint64_t start = now_usec();
+  dbus_connection_send(conn, msg, nullptr);
+  dbus_connection_flush(conn);
+  dbus_message_unref(msg);
+
+  int received = 0;
+  while (received < count) {
+    dbus_connection_read_write(conn, 1000);
+    DBusMessage *signal;
+    while ((signal = dbus_connection_pop_message(conn)) != nullptr) {
+      if (dbus_message_is_signal(signal, SERVICE_IFACE, "Tick")) {
+        received++;
+      }
+      dbus_message_unref(signal);
+    }
+  }
+  double elapsed = (now_usec() - start) / 1e6;
+  dbus_bus_remove_match(conn, rule.c_str(), nullptr);
+
+  char json[256];
+  snprintf(json, sizeof(json),
+           "{\"signals\": %d, \"signals_per_sec\": %.1f}", count,
+           count / elapsed);
+  return json;
+}
+
+// Measures encoding, decoding and echoing the payload built by "build"
+static std::string bench_payload(DBusConnection *conn,
+                                 DBusMessage *(*build)(), int iterations) {
+  std::vector<double> encode;
+  std::vector<double> decode;
+  std::vector<double> round_trip;
+  int size = 0;
+  uint64_t values = 0;
+
+  for (int i = 0; i < iterations; i++) {
+    uint64_t begin = now_usec();
+    DBusMessage *msg = build();
+    encode.push_back((double)(now_usec() - begin));
+
+    begin = now_usec();
+    DBusMessage *reply = call(conn, msg);
+    round_trip.push_back((double)(now_usec() - begin));
+
+    begin = now_usec();
+    values = walk_message(reply);
+    decode.push_back((double)(now_usec() - begin));
+
+    char *data = nullptr;
+    if (dbus_message_marshal(reply, &data, &size)) {
+      dbus_free(data);
+    }
+    dbus_message_unref(reply);
+    dbus_message_unref(msg);
+  }
+
+  char json[512];
+  snprintf(json, sizeof(json),
+           "{\"bytes\": %d, \"values\": %llu, \"encode_usec\": %.1f, "
+           "\"decode_usec\": %.1f, \"round_trip_p50_usec\": %.1f, "
+           "\"round_trip_p99_usec\": %.1f}",
+           size, (unsigned long long)values, mean(encode), mean(decode),
+           percentile(round_trip, 50), percentile(round_trip, 99));
+  return json;
+}
+
+int main(int argc, char **argv) {
+  int scale = 1;
+  const char *output = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+      scale = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      output = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--scale N] [--output FILE]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (!dbus_threads_init_default()) {
+    fail("unable to initialize threads", nullptr);
+  }
+
+  BenchDaemon daemon;
+  daemon.start();
+  EchoService service;
+  service.start(daemon.address);
+  DBusConnection *conn = open_bus(daemon.address);
+
+  // Warm up both connections and the daemon before measuring
+  bench_ping(conn, 200);
+
+  std::string ping = bench_ping(conn, 5000 * scale);
+  std::string signals = bench_signals(conn, 20000 * scale);
+  std::string asv = bench_payload(conn, build_asv, 2000 * scale);
+  std::string managed =
+      bench_payload(conn, build_managed_objects, 200 * scale);
+  std::string bytes = bench_payload(conn, build_bytes, 50 * scale);
+
+  dbus_connection_close(conn);
+  dbus_connection_unref(conn);
+  service.stop();
+  daemon.stop();
+
+  int major = 0;
+  int minor = 0;
+  int micro = 0;
+  dbus_get_version(&major, &minor, &micro);
+
+  FILE *out = stdout;
+  if (output != nullptr) {
+    out = fopen(output, "w");
+    if (out == nullptr) {
+      fail("unable to open output file", nullptr);
+    }
+  }
+  fprintf(out,
+          "{\n"
+          "  \"libdbus\": \"%d.%d.%d\",\n"
+          "  \"scale\": %d,\n"
+          "  \"ping\": %s,\n"
+          "  \"signals\": %s,\n"
+          "  \"payloads\": {\n"
+          "    \"a{sv}\": %s,\n"
+          "    \"a{oa{sa{sv}}}\": %s,\n"
+          "    \"ay_1MiB\": %s\n"
+          "  }\n"
+          "}\n",
+          major, minor, micro, scale, ping.c_str(), signals.c_str(),
+          asv.c_str(), managed.c_str(), bytes.c_str());
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  return 0;
+}
@@ -0,0 +1,240 @@
+extends SceneTree
+# Benchmark for the extension itself. It runs inside a headless Godot with the
+# built extension loaded, exports an echo object on one DBus connection and
+# calls it from another, so every call goes through the extension's
+# marshaling, dispatch and pending call paths. It measures method call round
+# trips, signal dispatch and the cost of encoding and decoding the same
+# payloads as bench/dbus_bench. Results are written as JSON so that runs can be
+# compared with each other and with the libdbus baseline.
+#
+# Usage (see "make bench-extension"):
+#   dbus-run-session -- godot --headless --path ./demo \
+#       --script bench/extension_bench.gd -- [--scale N] [--output FILE]
+
+const BENCH_PATH := "/org/godot/DBusBench"
+const BENCH_IFACE := "org.godot.DBusBench"
+
+var server := DBus.new()
+var client := DBus.new()
+var server_name := ""
+var signals_received := 0
+
+
+func _initialize() -> void:
+	quit(run())
+
+
+# Runs every benchmark and writes the results. Returns the exit code.
+func run() -> int:
+	var scale := 1
+	var output := ""
+	var args := OS.get_cmdline_user_args()
+	for i in args.size():
+		if args[i] == "--scale" and i + 1 < args.size():
+			scale = maxi(1, args[i + 1].to_int())
+		elif args[i] == "--output" and i + 1 < args.size():
+			output = args[i + 1]
+
+	if server.connect_private(DBus.DBUS_BUS_SESSION) != OK:
+		printerr("extension_bench: unable to connect to the session bus")
+		return 1
+	if client.connect_private(DBus.DBUS_BUS_SESSION) != OK:
+		printerr("extension_bench: unable to connect to the session bus")
+		return 1
+	server_name = server.get_unique_name()
+
+	var handlers := {
+		"Ping": _ping,
+		"EchoDict": {"callable": _echo, "signature": "a{sv}"},
+		"EchoTree": {"callable": _echo, "signature": "a{oa{sa{sv}}}"},
+		"EchoBytes": {"callable": _echo, "signature": "ay"},
+	}
+	if server.register_object(BENCH_PATH, BENCH_IFACE, handlers) != OK:
+		printerr("extension_bench: unable to export the echo object")
+		return 1
+
+	var results := {
+		"scale": scale,
+		"ping": bench_ping(5000 * scale),
+		"signals": bench_signals(1000 * scale),
+		"payloads": {
+			"a{sv}": bench_payload("EchoDict", "a{sv}", build_asv(),
+					2000 * scale),
+			"a{oa{sa{sv}}}": bench_payload("EchoTree", "a{oa{sa{sv}}}",
+					build_managed_objects(), 200 * scale),
+			"ay_1MiB": bench_payload("EchoBytes", "ay", build_bytes(),
+					50 * scale),
+		},
+	}
+
+	var json := JSON.stringify(results, "  ")
+	if output.is_empty():
+		print(json)
+		return 0
+	var file := FileAccess.open(output, FileAccess.WRITE)
+	if not file:
+		printerr("extension_bench: unable to open output file ", output)
+		return 1
+	file.store_line(json)
+	return 0
+
+
+func _ping() -> void:
+	pass
+
+
+func _echo(value):
+	return value
+
+
+# Calls a method on the echo object and pumps both connections until the
+# reply arrives. Returns the completed pending call.
+func call_echo(method: String, args: Array,
+		signature: String) -> DBusPendingCall:
+	var pending := client.send_async(server_name, BENCH_PATH, BENCH_IFACE,
+			method, args, signature)
+	while pending and pending.is_pending():
+		server.dispatch()
+		client.dispatch()
+	return pending
+
+
+# Measures round trips of an argument-less call
+func bench_ping(iterations: int) -> Dictionary:
+	var samples := PackedFloat64Array()
+	var start := Time.get_ticks_usec()
+	for i in iterations:
+		var begin := Time.get_ticks_usec()
+		call_echo("Ping", [], "")
+		samples.append(Time.get_ticks_usec() - begin)
+	var elapsed := (Time.get_ticks_usec() - start) / 1e6
+
+	return {
+		"calls": iterations,
+		"calls_per_sec": iterations / elapsed,
+		"p50_usec": percentile(samples, 50),
+		"p99_usec": percentile(samples, 99),
+	}
+
+
+func _on_name_owner_changed(_msg: DBusMessage) -> void:
+	signals_received += 1
+
+
+# Measures how long dispatch takes to deliver signals to a subscription.
+# Scripts cannot emit signals, so the signals are the NameOwnerChanged
+# broadcasts caused by opening and closing private connections. Only the time
+# spent in dispatch is counted.
+func bench_signals(count: int) -> Dictionary:
+	var id := client.subscribe("org.freedesktop.DBus", "/org/freedesktop/DBus",
+			"org.freedesktop.DBus", "NameOwnerChanged", _on_name_owner_changed)
+	signals_received = 0
+
+	# Every connection is announced once when it opens and once when it closes
+	for i in count / 2:
+		var peer := DBus.new()
+		peer.connect_private(DBus.DBUS_BUS_SESSION)
+
+	var dispatch_usec := 0
+	var deadline := Time.get_ticks_msec() + 10000
+	while signals_received < count and Time.get_ticks_msec() < deadline:
+		var begin := Time.get_ticks_usec()
+		client.dispatch()
+		dispatch_usec += Time.get_ticks_usec() - begin
+	client.unsubscribe(id)
+
+	var seconds := maxf(dispatch_usec / 1e6, 1e-6)
+	return {
+		"signals": signals_received,
+		"dispatch_usec": dispatch_usec,
+		"signals_per_sec": signals_received / seconds,
+	}
+
+
+# Measures encoding, decoding and echoing the given payload. Encoding is the
+# time send_async takes to build and queue the call, and decoding the time
+# get_args takes on the reply.
+func bench_payload(method: String, signature: String, payload,
+		iterations: int) -> Dictionary:
+	var encode := PackedFloat64Array()
+	var decode := PackedFloat64Array()
+	var round_trip := PackedFloat64Array()
+
+	for i in iterations:
+		var begin := Time.get_ticks_usec()
+		var pending := client.send_async(server_name, BENCH_PATH, BENCH_IFACE,
+				method, [payload], signature)
+		encode.append(Time.get_ticks_usec() - begin)
+		if not pending:
+			printerr("extension_bench: unable to call ", method)
+			return {}
+		while pending.is_pending():
+			server.dispatch()
+			client.dispatch()
+		round_trip.append(Time.get_ticks_usec() - begin)
+
+		var reply := pending.get_reply()
+		if not reply or reply.get_type() == DBusMessage.DBUS_MESSAGE_TYPE_ERROR:
+			printerr("extension_bench: ", method, " failed")
+			return {}
+		begin = Time.get_ticks_usec()
+		reply.get_args()
+		decode.append(Time.get_ticks_usec() - begin)
+
+	return {
+		"encode_usec": mean(encode),
+		"decode_usec": mean(decode),
+		"round_trip_p50_usec": percentile(round_trip, 50),
+		"round_trip_p99_usec": percentile(round_trip, 99),
+	}
+
+
+# Builds a property dictionary like the ones sent with PropertiesChanged
+func build_asv() -> Dictionary:
+	var props := {}
+	for i in 8:
+		props["String%d" % i] = "value %d" % i
+		props["Int%d" % i] = i * 1000
+		props["Bool%d" % i] = i % 2 == 0
+		props["Float%d" % i] = i * 0.5
+	return props
+
+
+# Builds a GetManagedObjects reply with 50 objects of two interfaces each
+func build_managed_objects() -> Dictionary:
+	var objects := {}
+	for i in 50:
+		var interfaces := {}
+		interfaces["org.godot.Device1"] = build_asv()
+		interfaces["org.godot.Battery1"] = {"Percentage": 50, "Charging": true}
+		objects["/org/godot/device%d" % i] = interfaces
+	return objects
+
+
+# Builds a 1 MiB byte array
+func build_bytes() -> PackedByteArray:
+	var bytes := PackedByteArray()
+	bytes.resize(1 << 20)
+	for i in bytes.size():
+		bytes[i] = i & 0xff
+	return bytes
+
+
+# Returns the given percentile of the samples
+func percentile(samples: PackedFloat64Array, pct: float) -> float:
+	if samples.is_empty():
+		return 0.0
+	var sorted := samples.duplicate()
+	sorted.sort()
+	var index := mini(int(pct / 100.0 * sorted.size()), sorted.size() - 1)
+	return sorted[index]
+
+
+# Returns the mean of the samples
+func mean(samples: PackedFloat64Array) -> float:
+	if samples.is_empty():
+		return 0.0
+	var total := 0.0
+	for sample in samples:
+		total += sample
+	return total / samples.size()
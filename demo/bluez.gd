@@ -2,6 +2,7 @@ extends Resource
 class_name Bluez
 
 var dbus := DBus.new()
+var object_manager: DBusObjectManagerMirror
 
 
 func _init() -> void:
@@ -14,13 +15,12 @@ func _init() -> void:
 
 
 func _process(_delta: float) -> void:
-	var msg := dbus.pop_message()
-	if not msg:
-		return
-	
-	# Message to process!
-	print("Got message!")
-	print(msg.get_args())
+	# Drain up to 64 messages, spending at most 2ms per frame
+	var messages := dbus.pop_messages(64, 2000)
+	for msg in messages:
+		# Message to process!
+		print("Got message!")
+		print(msg.get_args())
 
 
 func get_discovery_filters(device: String = "hci0") -> PackedStringArray:
@@ -53,6 +53,16 @@ func get_managed_objects():
 		print("Discovered device [", device["Address"], "] at object path: ", obj_path)
 
 
+# Returns the object paths of all known devices without re-fetching the whole
+# object tree
+func get_device_paths() -> PackedStringArray:
+	if not object_manager:
+		object_manager = dbus.create_object_manager_mirror("org.bluez", "/")
+	if not object_manager:
+		return PackedStringArray()
+	return object_manager.get_paths_with_interface("org.bluez.Device1")
+
+
 func start_discovery():
 	var response := dbus.send_with_reply_and_block("org.bluez", "/org/bluez/hci0", "org.bluez.Adapter1", "StartDiscovery", [], "")
 
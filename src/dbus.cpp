@@ -1,9 +1,26 @@
 #include "dbus.h"
 #include "dbus/dbus-protocol.h"
 #include "dbus/dbus.h"
+#include "dbus_event_loop.h"
 #include "dbus_message.h"
+#include "dbus_name_watcher.h"
+#include "dbus_object_manager_mirror.h"
+#include "dbus_pending_call.h"
+#include "dbus_property_cache.h"
+#include "dbus_proxy.h"
+#include "dbus_unix_fd.h"
+#include "godot_cpp/classes/performance.hpp"
+#include "godot_cpp/classes/time.hpp"
+#include "godot_cpp/variant/packed_float64_array.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/packed_int64_array.hpp"
 #include "godot_cpp/variant/utility_functions.hpp"
+#include <cerrno>
+#include <chrono>
 #include <cstdio>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // References:
 // http://www.matthew.ath.cx/misc/dbus
@@ -12,15 +29,47 @@
 using godot::Array;
 using godot::ClassDB;
 using godot::D_METHOD;
+using godot::Ref;
 using godot::Dictionary;
 using godot::String;
 using godot::Variant;
 
+// Timeout libdbus uses for DBUS_TIMEOUT_USE_DEFAULT
+static const int DEFAULT_TIMEOUT_MS = 25000;
+
 DBus::DBus(){};
 DBus::~DBus() {
+  stop_io_thread();
+  stop_capture();
+  set_stats_monitors_enabled(false);
+
+  // Drop any outstanding async calls
+  for (const godot::KeyValue<uint32_t, godot::Ref<DBusPendingCall>> &entry :
+       pending_calls) {
+    entry.value->cancel();
+  }
+  pending_calls.clear();
+
   if (dbus_conn == nullptr) {
     return;
   }
+
+  // Remove the match rules of any remaining subscriptions, since the
+  // connection may be shared with other DBus objects
+  godot::Vector<String> rules = signal_table.get_rules();
+  for (int i = 0; i < rules.size(); i++) {
+    if (rules[i].is_empty()) {
+      continue;
+    }
+    ::dbus_bus_remove_match(dbus_conn, rules[i].ascii().get_data(), nullptr);
+  }
+  signal_table.clear();
+
+  // Private connections are owned by this object and must be closed before
+  // the last reference is dropped
+  if (private_conn) {
+    ::dbus_connection_close(dbus_conn);
+  }
   // When using the System Bus, unreference
   // the connection instead of closing it
   ::dbus_connection_unref(dbus_conn);
@@ -28,6 +77,10 @@ DBus::~DBus() {
 
 // Connect to the dbus interface
 int DBus::connect(int bus_type) {
+  if (dbus_conn != nullptr) {
+    godot::UtilityFunctions::push_error("A dbus connection already exists");
+    return godot::ERR_ALREADY_IN_USE;
+  }
   DBusError dbus_error;
 
   // Initialize D-Bus error
@@ -44,6 +97,64 @@ int DBus::connect(int bus_type) {
   return godot::OK;
 };
 
+// Connect to the given message bus with a connection of our own instead of
+// the connection shared by the whole process. Messages on a private
+// connection do not queue up behind those of other DBus objects.
+int DBus::connect_private(int bus_type) {
+  if (dbus_conn != nullptr) {
+    godot::UtilityFunctions::push_error("A dbus connection already exists");
+    return godot::ERR_ALREADY_IN_USE;
+  }
+  DBusError dbus_error;
+  ::dbus_error_init(&dbus_error);
+
+  dbus_conn = ::dbus_bus_get_private((DBusBusType)bus_type, &dbus_error);
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_warning("Unable to connect to bus: ",
+                                          dbus_error.name, " ",
+                                          dbus_error.message);
+    ::dbus_error_free(&dbus_error);
+    return godot::ERR_CANT_CONNECT;
+  }
+  private_conn = true;
+
+  // Losing the connection should not terminate the game
+  ::dbus_connection_set_exit_on_disconnect(dbus_conn, false);
+
+  return godot::OK;
+}
+
+// Opens a peer-to-peer connection to the given address, e.g.
+// "unix:path=/run/user/1000/helper", without going through a message bus.
+// There is no bus on such a connection, so match rules and bus names do not
+// apply and every signal sent by the peer is delivered.
+int DBus::open_address(String address) {
+  if (dbus_conn != nullptr) {
+    godot::UtilityFunctions::push_error("A dbus connection already exists");
+    return godot::ERR_ALREADY_IN_USE;
+  }
+  DBusError dbus_error;
+  ::dbus_error_init(&dbus_error);
+
+  dbus_conn = ::dbus_connection_open_private(address.utf8().get_data(),
+                                             &dbus_error);
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_warning("Unable to open address ", address,
+                                          ": ", dbus_error.name, " ",
+                                          dbus_error.message);
+    ::dbus_error_free(&dbus_error);
+    return godot::ERR_CANT_CONNECT;
+  }
+  private_conn = true;
+  peer_conn = true;
+  ::dbus_connection_set_exit_on_disconnect(dbus_conn, false);
+
+  return godot::OK;
+}
+
+// Returns true if the connection is a peer-to-peer connection
+bool DBus::is_peer_to_peer() { return peer_conn; }
+
 // Adds a match rule to match messages going through the message bus.
 // The "rule" argument is the string form of a match rule.
 // Example: "type='signal',interface='test.signal.Type'"
@@ -102,337 +213,2094 @@ int DBus::remove_match(godot::String rule) {
 // Pop the next available message from the bus and return it. This should be
 // used in conjunction with add_match to listen for messages.
 DBusMessage *DBus::pop_message() {
-  if (dbus_conn == nullptr) {
+  if (dbus_conn == nullptr && replay_source.is_null()) {
     godot::UtilityFunctions::push_error("No dbus connection exists");
     return nullptr;
   }
 
-  // non blocking read of the next available message
-  ::dbus_connection_read_write(dbus_conn, 0);
-  ::DBusMessage *msg = ::dbus_connection_pop_message(dbus_conn);
+  // non blocking read of the next available message, skipping over any
+  // messages that are consumed natively (e.g. replies to async calls)
+  read_available();
+  ::DBusMessage *msg;
+  while ((msg = next_message()) != nullptr && route_message(msg)) {
+  }
+  expire_pending_calls();
   if (msg == nullptr) {
     return nullptr;
   }
 
-  // Create a new message object to contain the reply
-  DBusMessage *response = memnew(DBusMessage());
-  response->message = msg;
+  // Wrap the message in a message object, reused from the pool if enabled
+  return wrap_message(msg);
+}
 
-  return response;
+// Quotes a value for use in a match rule. Match rules have no escapes inside
+// quotes, so an apostrophe ends the quoted part, is escaped and starts a new
+// one.
+static String quote_match_value(const String &value) {
+  return "'" + value.replace("'", "'\\''") + "'";
 }
 
-// Sets the given argument on the DBusMessage with the given iterator
-void append_arg(DBusMessageIter *iter, Variant variant,
-                DBusSignatureIter *sig_iter) {
-  const auto variant_type = variant.get_type();
-  const char arg_type = ::dbus_signature_iter_get_current_type(sig_iter);
+// Subscribe to a signal. A match rule is added for the signal, and matching
+// signals are delivered to the given callable with the DBusMessage as its only
+// argument instead of being returned by pop_message. Any of the arguments may
+// be empty to match all senders, paths, interfaces or members. If "arg0" is
+// not empty, only signals whose first argument is that string match. The
+// owner of a well-known sender name is resolved once with a blocking call and
+// then tracked. Returns the id of the subscription, or -1 if the match rule
+// could not be added.
+int DBus::subscribe(String sender, String path, String iface, String member,
+                    godot::Callable callable, String arg0) {
+  if (dbus_conn == nullptr && replay_source.is_null()) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return -1;
+  }
 
-  if (arg_type == DBUS_TYPE_STRING) {
-    String arg = String(variant);
-    // Duplicate the string and append it to the message
-    const char *data = String(arg.ascii().get_data()).ascii().get_data();
-    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_STRING, &data);
-    return;
+  // Build the match rule for the signal
+  String rule = "type='signal'";
+  if (!sender.is_empty()) {
+    rule += ",sender=" + quote_match_value(sender);
   }
-  if (arg_type == DBUS_TYPE_INT32) {
-    dbus_int32_t arg = (dbus_int32_t)variant;
-    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_INT32, &arg);
-    return;
+  if (!path.is_empty()) {
+    rule += ",path=" + quote_match_value(path);
   }
-  if (arg_type == DBUS_TYPE_UINT32) {
-    dbus_uint32_t arg = (dbus_uint32_t)variant;
-    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_UINT32, &arg);
-    return;
+  if (!iface.is_empty()) {
+    rule += ",interface=" + quote_match_value(iface);
   }
-  if (arg_type == DBUS_TYPE_DOUBLE) {
-    double arg = (double)variant;
-    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_DOUBLE, &arg);
+  if (!member.is_empty()) {
+    rule += ",member=" + quote_match_value(member);
+  }
+  if (!arg0.is_empty()) {
+    rule += ",arg0=" + quote_match_value(arg0);
+  }
+
+  // A peer sends its signals straight to us, and replayed signals do not
+  // come from a bus, so there is no bus to add the match rule to
+  if (peer_conn || dbus_conn == nullptr) {
+    rule = String();
+  } else if (add_match(rule) != godot::OK) {
+    return -1;
+  }
+  track_owner(sender);
+
+  return signal_table.add(sender, path, iface, member, arg0, callable, rule);
+}
+
+// Starts tracking the owner of a well-known name used as the sender of a
+// subscription. Signals carry the unique name of their sender, and other match
+// rules on a shared connection deliver the same signals from any sender, so
+// subscriptions are matched against the tracked owner. The NameOwnerChanged
+// rule is added before the owner is resolved so that no change is missed.
+void DBus::track_owner(const String &sender) {
+  if (sender.is_empty() || sender.begins_with(":") ||
+      sender == DBUS_SERVICE_DBUS || peer_conn || dbus_conn == nullptr) {
     return;
   }
-  if (arg_type == DBUS_TYPE_BOOLEAN) {
-    dbus_bool_t arg = variant.booleanize();
-    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_BOOLEAN, &arg);
+  if (signal_table.ref_owner(sender)) {
     return;
   }
-  // if (arg_type == DBUS_TYPE_DICT_ENTRY) {
-  //   return;
-  // }
-
-  // Handle arrays and dictionaries
-  if (arg_type == DBUS_TYPE_ARRAY) {
-    const char *arr_sig = ::dbus_signature_iter_get_signature(sig_iter);
-    godot::UtilityFunctions::print("Recursed into sig ", arr_sig);
-    DBusMessageIter arr_iter;
-    int array_type = ::dbus_signature_iter_get_element_type(sig_iter);
-
-    // Handle dictionaries.
-    if (array_type == DBUS_TYPE_DICT_ENTRY) {
-      // godot::UtilityFunctions::print("Found dictionary");
-
-      // Ensure the passed variant is a dictionary
-      if (variant_type != variant.DICTIONARY) {
-        godot::UtilityFunctions::push_warning(
-            "Passed dictionary signature without dictionary argument");
-        return;
-      }
-      Dictionary dict = Dictionary(variant);
-
-      // Recurse into the signature
-      DBusSignatureIter dict_sig_iter;
-      ::dbus_signature_iter_recurse(sig_iter, &dict_sig_iter);
-
-      // Get the dictionary signature from the signature. The '{sv}' part of
-      // 'a{sv}'
-      const char *dict_sig =
-          ::dbus_signature_iter_get_signature(&dict_sig_iter);
-      // godot::UtilityFunctions::print("Found dictionary signature: ",
-      // dict_sig);
-
-      // Open the array container
-      ::dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, dict_sig,
-                                         &arr_iter);
-
-      // Loop through the dictionary and append the key/value pairs
-      Array keys = dict.keys();
-      for (int i = 0; i < keys.size(); i++) {
-        // TODO: Implement this
-        // Variant key = keys[i];
-        // DBusMessageIter entry_iter;
-
-        //// Open the dictionary entry container
-        //::dbus_message_iter_open_container(&arr_iter, );
-      }
 
-      // Close the array
-      ::dbus_message_iter_close_container(iter, &arr_iter);
+  String rule = "type='signal',sender='" DBUS_SERVICE_DBUS
+                "',path='" DBUS_PATH_DBUS "',interface='" DBUS_INTERFACE_DBUS
+                "',member='NameOwnerChanged',arg0=" +
+                quote_match_value(sender);
+  if (add_match(rule) != godot::OK) {
+    rule = String();
+  }
 
-      return;
+  // Resolve the current owner. A name without an owner replies with an
+  // error and is tracked with an empty owner.
+  String owner;
+  ::DBusMessage *msg = ::dbus_message_new_method_call(
+      DBUS_SERVICE_DBUS, DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS, "GetNameOwner");
+  godot::CharString name = sender.utf8();
+  const char *name_data = name.get_data();
+  ::dbus_message_append_args(msg, DBUS_TYPE_STRING, &name_data,
+                             DBUS_TYPE_INVALID);
+  ::DBusMessage *reply = ::dbus_connection_send_with_reply_and_block(
+      dbus_conn, msg, DBUS_TIMEOUT_USE_DEFAULT, nullptr);
+  ::dbus_message_unref(msg);
+  if (reply != nullptr) {
+    const char *owner_data = nullptr;
+    if (::dbus_message_get_args(reply, nullptr, DBUS_TYPE_STRING, &owner_data,
+                                DBUS_TYPE_INVALID)) {
+      owner = String::utf8(owner_data);
     }
+    ::dbus_message_unref(reply);
+  }
 
-    // Handle regular arrays
-    // Recurse into the signature
-    DBusSignatureIter array_sig_iter;
-    ::dbus_signature_iter_recurse(sig_iter, &array_sig_iter);
-    const char *array_sig =
-        ::dbus_signature_iter_get_signature(&array_sig_iter);
-    godot::UtilityFunctions::print("Found array signature: ", array_sig);
+  signal_table.add_owner(sender, owner, rule);
+}
 
-    // Open the array container
-    ::dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, array_sig,
-                                       &arr_iter);
+// Removes a subscription created with subscribe
+int DBus::unsubscribe(int id) {
+  String rule;
+  String sender;
+  if (!signal_table.remove(id, &rule, &sender)) {
+    return godot::ERR_DOES_NOT_EXIST;
+  }
+  String owner_rule;
+  if (signal_table.unref_owner(sender, &owner_rule) && dbus_conn != nullptr) {
+    remove_match(owner_rule);
+  }
+  if (dbus_conn == nullptr || rule.is_empty()) {
+    return godot::OK;
+  }
+  return remove_match(rule);
+}
 
-    // Convert the Godot Variant to a Godot Array
-    Array array = Array(variant);
-    for (int i = 0; i < array.size(); i++) {
-      Variant element = array[i];
-      append_arg(&arr_iter, element, &array_sig_iter);
-    }
+// Exports an interface on the bus at the given object path. Each entry of
+// "handlers" maps a method name to either a Callable, for methods that reply
+// without arguments, or a Dictionary with the "callable" to invoke, the
+// "signature" of its reply and optionally the "in_signature" of its arguments
+// for introspection. Handlers are called with the arguments of the call and
+// their return value is sent back as the reply, using an Array when the reply
+// has more than one argument. A handler fails the call by returning a
+// Dictionary with only an "error_name" and an optional "error_message".
+//
+// Each entry of "properties" maps a property name to a Dictionary with its
+// "signature", a "getter" Callable and an optional "setter" Callable taking
+// the new value. They are served through org.freedesktop.DBus.Properties, and
+// org.freedesktop.DBus.Introspectable describes everything exported. Calls are
+// handled while the connection is pumped with dispatch, pop_message or
+// pop_messages.
+int DBus::register_object(String path, String iface, Dictionary handlers,
+                          Dictionary properties) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CONNECTION_ERROR;
+  }
+  if (!::dbus_validate_path(path.ascii().get_data(), nullptr) ||
+      !::dbus_validate_interface(iface.ascii().get_data(), nullptr)) {
+    godot::UtilityFunctions::push_error("Invalid object path or interface: ",
+                                        path, " ", iface);
+    return godot::ERR_INVALID_PARAMETER;
+  }
 
-    // Close the array
-    ::dbus_message_iter_close_container(iter, &arr_iter);
+  return object_table.add(path, iface, handlers, properties);
+}
 
-    return;
+// Stops exporting an interface, or every interface at the given path if
+// "iface" is empty.
+int DBus::unregister_object(String path, String iface) {
+  if (!object_table.remove(path, iface)) {
+    return godot::ERR_DOES_NOT_EXIST;
   }
+  return godot::OK;
+}
 
-  // Handle variant types
-  // TODO: Why is it 119!? If we pass 'v' (ASCII value 118), for some reason it
-  // shows up here at 119 instead.
-  if (arg_type == DBUS_TYPE_VARIANT || arg_type == 119) {
-    DBusMessageIter sub_iter;
-    DBusSignatureIter sub_sig_iter;
-    if (variant_type == variant.BOOL) {
-      ::dbus_signature_iter_init(&sub_sig_iter, DBUS_TYPE_BOOLEAN_AS_STRING);
-      ::dbus_message_iter_open_container(
-          iter, DBUS_TYPE_VARIANT, DBUS_TYPE_BOOLEAN_AS_STRING, &sub_iter);
-      append_arg(&sub_iter, variant, &sub_sig_iter);
-      ::dbus_message_iter_close_container(iter, &sub_iter);
-
-      return;
-    }
-    if (variant_type == variant.STRING) {
-      ::dbus_signature_iter_init(&sub_sig_iter, DBUS_TYPE_STRING_AS_STRING);
-      ::dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT,
-                                         DBUS_TYPE_STRING_AS_STRING, &sub_iter);
-      append_arg(&sub_iter, variant, &sub_sig_iter);
-      ::dbus_message_iter_close_container(iter, &sub_iter);
-
-      return;
-    }
-    if (variant_type == variant.INT) {
-      ::dbus_signature_iter_init(&sub_sig_iter, DBUS_TYPE_INT32_AS_STRING);
-      ::dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT,
-                                         DBUS_TYPE_INT32_AS_STRING, &sub_iter);
-      append_arg(&sub_iter, variant, &sub_sig_iter);
-      ::dbus_message_iter_close_container(iter, &sub_iter);
-
-      return;
-    }
-    if (variant_type == variant.FLOAT) {
-      ::dbus_signature_iter_init(&sub_sig_iter, DBUS_TYPE_DOUBLE_AS_STRING);
-      ::dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT,
-                                         DBUS_TYPE_DOUBLE_AS_STRING, &sub_iter);
-      append_arg(&sub_iter, variant, &sub_sig_iter);
-      ::dbus_message_iter_close_container(iter, &sub_iter);
-      return;
-    }
-
-    if (variant_type == variant.OBJECT) {
-      godot::Object *object = (godot::Object *)variant;
-      const godot::String class_name = object->get_class();
-      // godot::UtilityFunctions::print("Got object: ", class_name);
-
-      if (class_name == "DBusUInt32") {
-        DBusUInt32 *dbus_uint32 = (DBusUInt32 *)object;
-        ::dbus_signature_iter_init(&sub_sig_iter, DBUS_TYPE_UINT32_AS_STRING);
-        ::dbus_message_iter_open_container(
-            iter, DBUS_TYPE_VARIANT, DBUS_TYPE_UINT32_AS_STRING, &sub_iter);
-        append_arg(&sub_iter, dbus_uint32->get_value(), &sub_sig_iter);
-        ::dbus_message_iter_close_container(iter, &sub_iter);
-
-        return;
-      }
-      godot::UtilityFunctions::push_warning(
-          "Invalid/unhandled Godot object type: ", class_name);
-      return;
-    }
+// Creates a cache of all properties of the given interface on a remote object.
+// The properties are fetched once and then kept up to date from the
+// PropertiesChanged signal, which is delivered while the connection is pumped
+// with dispatch, pop_message or pop_messages.
+DBusPropertyCache *DBus::create_property_cache(String bus_name, String path,
+                                               String iface) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return nullptr;
+  }
 
-    godot::UtilityFunctions::push_warning("Invalid/unhandled variant type: ",
-                                          variant_type);
-    return;
+  DBusPropertyCache *cache = memnew(DBusPropertyCache());
+  cache->dbus = godot::Ref<DBus>(this);
+  cache->bus_name = bus_name;
+  cache->path = path;
+  cache->iface = iface;
+  if (cache->start() != godot::OK) {
+    memdelete(cache);
+    return nullptr;
   }
 
-  char output[10];
-  sprintf(output, "%c", arg_type);
-  godot::UtilityFunctions::push_warning("Invalid/unhandled argument type: ",
-                                        output);
+  return cache;
 }
 
-// Send the given message and wait for a reply
-DBusMessage *DBus::send_with_reply_and_block(String bus_name, String path,
-                                             String iface, String method,
-                                             Array args, String signature) {
+// Creates a local replica of the object tree exported by the ObjectManager at
+// the given path. The tree is fetched once and then updated incrementally from
+// signals delivered while the connection is pumped with dispatch, pop_message
+// or pop_messages.
+DBusObjectManagerMirror *DBus::create_object_manager_mirror(String bus_name,
+                                                            String path) {
   if (dbus_conn == nullptr) {
     godot::UtilityFunctions::push_error("No dbus connection exists");
     return nullptr;
   }
 
-  // Create an initialize the error struct
-  DBusError dbus_error;
-  ::dbus_error_init(&dbus_error);
+  DBusObjectManagerMirror *mirror = memnew(DBusObjectManagerMirror());
+  mirror->dbus = godot::Ref<DBus>(this);
+  mirror->bus_name = bus_name;
+  mirror->path = path;
+  if (mirror->start() != godot::OK) {
+    memdelete(mirror);
+    return nullptr;
+  }
 
-  // Validate the passed signature
-  if (!::dbus_signature_validate(signature.ascii().get_data(), &dbus_error)) {
-    godot::UtilityFunctions::push_warning(
-        "Invalid signature passed: ", dbus_error.name, " ", dbus_error.message);
-    ::dbus_error_free(&dbus_error);
+  return mirror;
+}
+
+// Creates an event loop that pumps the connection only when there is
+// something to do, instead of polling it every frame. Messages are dispatched
+// as with dispatch, so they have to be consumed by subscriptions, exported
+// objects or pending calls.
+DBusEventLoop *DBus::create_event_loop() {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
     return nullptr;
   }
 
-  // Build the message to send
-  ::DBusMessage *reply = nullptr;
-  ::DBusMessage *msg = ::dbus_message_new_method_call(
-      bus_name.ascii().get_data(), path.ascii().get_data(),
-      iface.ascii().get_data(), method.ascii().get_data());
+  DBusEventLoop *loop = memnew(DBusEventLoop());
+  loop->dbus = godot::Ref<DBus>(this);
+  if (loop->start() != godot::OK) {
+    memdelete(loop);
+    return nullptr;
+  }
 
-  // Create an iterator to append arguments to the message
-  DBusMessageIter iter;
-  ::dbus_message_iter_init_append(msg, &iter);
+  return loop;
+}
+
+// Starts tracking the owner of the given bus name. The owner is resolved once
+// and then updated from signals delivered while the connection is pumped
+// with dispatch, pop_message or pop_messages, so the returned watcher answers
+// has_owner and get_owner without a round trip to the bus.
+DBusNameWatcher *DBus::watch_name(String name) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return nullptr;
+  }
+  if (peer_conn) {
+    godot::UtilityFunctions::push_error(
+        "Names cannot be watched on a peer-to-peer connection");
+    return nullptr;
+  }
 
-  // Create an iterator to iterate through and parse the signature
-  DBusSignatureIter sig_iter;
-  ::dbus_signature_iter_init(&sig_iter, signature.ascii().get_data());
+  DBusNameWatcher *watcher = memnew(DBusNameWatcher());
+  watcher->dbus = godot::Ref<DBus>(this);
+  watcher->name = name;
+  if (watcher->start() != godot::OK) {
+    memdelete(watcher);
+    return nullptr;
+  }
 
-  // Add arguments to the message. Here a cursor is also created so the
-  // signature can be traversed at a different rate than the arguments.
-  for (int i = 0; i < args.size(); i++) {
-    Variant variant = args[i];
-    // TODO: validate Godot types match signature
-    append_arg(&iter, variant, &sig_iter);
-    ::dbus_signature_iter_next(&sig_iter);
-    signature.ascii().get_data(); // WHY DOES THIS PREVENT GARBAGE MEMORY!?
+  return watcher;
+}
+
+// Creates a proxy for the remote object at the given path. The object is
+// introspected once per connection, so further proxies of the same object do
+// not touch the bus until clear_introspection_cache is called.
+DBusProxy *DBus::create_proxy(String bus_name, String path) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return nullptr;
   }
 
-  // Send the message and check for errors
-  reply = ::dbus_connection_send_with_reply_and_block(
-      dbus_conn, msg, DBUS_TIMEOUT_USE_DEFAULT, &dbus_error);
-  if (reply == nullptr) {
-    godot::UtilityFunctions::push_warning(
-        "Unable to send message ", iface, ".", method, "(", args,
-        "): ", dbus_error.name, " ", dbus_error.message);
-    ::dbus_error_free(&dbus_error);
+  std::shared_ptr<const DBusIntrospection> introspection =
+      introspect(bus_name, path);
+  if (introspection == nullptr) {
     return nullptr;
   }
 
-  // Clean up the message
-  ::dbus_message_unref(msg);
-  ::dbus_error_free(&dbus_error);
+  DBusProxy *proxy = memnew(DBusProxy());
+  proxy->dbus = godot::Ref<DBus>(this);
+  proxy->bus_name = bus_name;
+  proxy->path = path;
+  proxy->introspection = introspection;
 
-  // Create a new message object to contain the reply
-  DBusMessage *response = memnew(DBusMessage());
-  response->message = reply;
+  return proxy;
+}
 
-  return response;
-};
+// Drops all cached introspection data, e.g. after a service was restarted
+// with a different API
+void DBus::clear_introspection_cache() { introspection_cache.clear(); }
+
+// Returns the parsed introspection data of the given object, calling
+// Introspect only if it is not cached yet
+std::shared_ptr<const DBusIntrospection> DBus::introspect(String bus_name,
+                                                          String path) {
+  // Neither bus names nor paths can contain spaces
+  String key = bus_name + " " + path;
+  std::shared_ptr<const DBusIntrospection> *cached =
+      introspection_cache.getptr(key);
+  if (cached != nullptr) {
+    return *cached;
+  }
 
-// Return the unique name of the client on the bus.
-String DBus::get_unique_name() {
-  if (dbus_conn == nullptr) {
-    return String();
+  godot::Ref<DBusMessage> reply = send_with_reply_and_block(
+      bus_name, path, "org.freedesktop.DBus.Introspectable", "Introspect",
+      Array(), "");
+  if (reply.is_null()) {
+    return nullptr;
   }
-  return String(::dbus_bus_get_unique_name(dbus_conn));
+  if (reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    godot::UtilityFunctions::push_warning("Unable to introspect ", path, ": ",
+                                          reply->get_error_name());
+    return nullptr;
+  }
+
+  // Hand the XML to the parser as is, without converting it to a String
+  const char *xml = nullptr;
+  if (!::dbus_message_get_args(reply->message, nullptr, DBUS_TYPE_STRING,
+                               &xml, DBUS_TYPE_INVALID)) {
+    godot::UtilityFunctions::push_warning("Invalid introspection data for ",
+                                          path);
+    return nullptr;
+  }
+  godot::PackedByteArray buffer;
+  buffer.resize(strlen(xml));
+  memcpy(buffer.ptrw(), xml, buffer.size());
+
+  std::shared_ptr<const DBusIntrospection> introspection =
+      DBusIntrospection::parse(buffer);
+  if (introspection == nullptr) {
+    godot::UtilityFunctions::push_warning("Unable to parse introspection of ",
+                                          path);
+    return nullptr;
+  }
+  introspection_cache.insert(key, introspection);
+
+  return introspection;
 }
 
-// Asks the bus to assign the given name to this connection by invoking the
-// RequestName method on the bus.
-bool DBus::name_has_owner(String name) {
-  if (dbus_conn == nullptr) {
+// Returns the earliest deadline of any pending call, or zero if there is none
+uint64_t DBus::get_next_deadline_usec() {
+  uint64_t next = 0;
+  for (const godot::KeyValue<uint32_t, godot::Ref<DBusPendingCall>> &entry :
+       pending_calls) {
+    uint64_t deadline = entry.value->deadline_usec;
+    if (deadline != 0 && (next == 0 || deadline < next)) {
+      next = deadline;
+    }
+  }
+  return next;
+}
+
+// Read up to "max_count" available messages from the bus and dispatch them to
+// subscribed callables and pending calls. Messages nobody is interested in are
+// dropped without ever being handed to a script. Returns the number of
+// messages that were dispatched.
+int DBus::dispatch(int max_count) {
+  if (dbus_conn == nullptr && replay_source.is_null()) {
     godot::UtilityFunctions::push_error("No dbus connection exists");
-    return false;
+    return 0;
   }
 
-  // Create an initialize the error struct
-  DBusError dbus_error;
-  ::dbus_error_init(&dbus_error);
+  // non blocking read of everything that is currently available
+  read_available();
 
-  bool ret = ::dbus_bus_name_has_owner(dbus_conn, name.ascii().get_data(),
-                                       &dbus_error);
-  if (::dbus_error_is_set(&dbus_error)) {
-    godot::UtilityFunctions::push_warning(
-        "Failed to see if name has owner: ", dbus_error.name, " ",
-        dbus_error.message);
+  int dispatched = 0;
+  ::DBusMessage *msg;
+  for (int i = 0; i < max_count && (msg = next_message()) != nullptr; i++) {
+    if (route_message(msg)) {
+      dispatched++;
+      continue;
+    }
+    drop_message(msg);
   }
-  dbus_error_free(&dbus_error);
+  expire_pending_calls();
 
-  return ret;
-};
+  return dispatched;
+}
 
-// Asks the bus to assign the given name to this connection by invoking the
-// RequestName method on the bus.
-int DBus::request_name(String name, unsigned int flags) {
+// Pop up to "max_count" available messages from the bus and return them as an
+// Array. Only a single read from the connection is done for the whole batch.
+// If "time_budget_usec" is greater than zero, draining stops once that much
+// time has been spent, leaving the remaining messages for the next call.
+Array DBus::pop_messages(int max_count, int time_budget_usec) {
+  Array messages = Array();
+  if (dbus_conn == nullptr && replay_source.is_null()) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return messages;
+  }
+
+  uint64_t deadline = 0;
+  if (time_budget_usec > 0) {
+    deadline = godot::Time::get_singleton()->get_ticks_usec() +
+               (uint64_t)time_budget_usec;
+  }
+
+  // non blocking read of everything that is currently available
+  read_available();
+
+  ::DBusMessage *msg;
+  while (messages.size() < max_count && (msg = next_message()) != nullptr) {
+    if (!route_message(msg)) {
+      // Wrap the message in a message object, reused from the pool if enabled
+      messages.append(wrap_message(msg));
+    }
+    if (deadline != 0 &&
+        godot::Time::get_singleton()->get_ticks_usec() >= deadline) {
+      break;
+    }
+  }
+  expire_pending_calls();
+
+  return messages;
+}
+
+// Reads everything that is currently available from the connection without
+// blocking. When the I/O thread or an event loop is running it has already
+// read the messages for us. Pooled wrappers that scripts let go of since the
+// last read are reclaimed first, so their messages are not kept alive.
+void DBus::read_available() {
+  message_pool.reclaim();
+  if (io_queue != nullptr) {
+    if (stats != nullptr) {
+      stats->queue_depth.add(io_queue->size());
+    }
+    return;
+  }
+  if (event_loop_attached || dbus_conn == nullptr) {
+    return;
+  }
+  if (stats == nullptr) {
+    ::dbus_connection_read_write(dbus_conn, 0);
+    return;
+  }
+  uint64_t begin = godot::Time::get_singleton()->get_ticks_usec();
+  ::dbus_connection_read_write(dbus_conn, 0);
+  stats->read_write_usec.add(godot::Time::get_singleton()->get_ticks_usec() -
+                             begin);
+}
+
+// Returns the next received message, either from the I/O thread queue or
+// straight from the connection. The caller takes ownership of the message.
+::DBusMessage *DBus::next_message() {
+  ::DBusMessage *msg = take_message();
+  if (msg == nullptr) {
+    return nullptr;
+  }
+  if (stats != nullptr) {
+    stats->count_message(msg, false);
+  }
+  if (capture.file.is_valid() &&
+      (replay_source.is_null() || !DBusReplaySource::is_replayed(msg))) {
+    capture.write(msg);
+  }
+  return msg;
+}
+
+// Takes the next received message off the replay source, the I/O thread queue
+// or the connection. Replayed messages come first while they are due.
+::DBusMessage *DBus::take_message() {
+  if (replay_source.is_valid()) {
+    ::DBusMessage *msg = replay_source->take_message();
+    if (msg != nullptr || dbus_conn == nullptr) {
+      return msg;
+    }
+  }
+  if (io_queue == nullptr) {
+    return ::dbus_connection_pop_message(dbus_conn);
+  }
+
+  ::DBusMessage *msg = nullptr;
+  if (io_queue->pop(msg) || !io_overflowed) {
+    return msg;
+  }
+
+  // Everything in the overflow list is newer than what was in the queue
+  std::lock_guard<std::mutex> lock(io_overflow_mutex);
+  if (io_overflow.empty()) {
+    return nullptr;
+  }
+  msg = io_overflow.front();
+  io_overflow.pop_front();
+  if (io_overflow.empty()) {
+    io_overflowed = false;
+  }
+  return msg;
+}
+
+// Starts a background thread that owns all reading from the connection. The
+// thread blocks on the socket, dispatches each received message and pushes it
+// onto a lock-free queue of "queue_size" entries, so pop_message only has to
+// dequeue it. Only one DBus object should run an I/O thread on a shared
+// connection.
+int DBus::start_io_thread(int queue_size) {
   if (dbus_conn == nullptr) {
     godot::UtilityFunctions::push_error("No dbus connection exists");
-    return godot::ERR_CANT_CONNECT;
+    return godot::ERR_CONNECTION_ERROR;
+  }
+  if (io_queue != nullptr) {
+    return godot::ERR_ALREADY_IN_USE;
+  }
+  if (event_loop_attached) {
+    godot::UtilityFunctions::push_error(
+        "Cannot start the I/O thread while an event loop is running");
+    return godot::ERR_ALREADY_IN_USE;
+  }
+  if (queue_size <= 0) {
+    godot::UtilityFunctions::push_error("Invalid I/O queue size: ",
+                                        queue_size);
+    return godot::ERR_INVALID_PARAMETER;
   }
 
-  // Create an initialize the error struct
-  DBusError dbus_error;
-  ::dbus_error_init(&dbus_error);
+  // The connection will now be used from more than one thread
+  if (!::dbus_threads_init_default()) {
+    return godot::ERR_OUT_OF_MEMORY;
+  }
 
-  int ret = ::dbus_bus_request_name(dbus_conn, name.ascii().get_data(), flags,
-                                    &dbus_error);
-  if (::dbus_error_is_set(&dbus_error)) {
-    godot::UtilityFunctions::push_warning(
-        "Failed to request name: ", dbus_error.name, " ", dbus_error.message);
+  // Used to wake the thread up when there is something to write or a message
+  // was queued by another thread
+  io_wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (io_wake_fd < 0) {
+    godot::UtilityFunctions::push_error("Unable to create I/O wake fd");
+    return godot::ERR_CANT_CREATE;
   }
-  dbus_error_free(&dbus_error);
 
-  return ret;
-};
+  // Messages are collected through a filter during dispatch, so that replies
+  // to blocking calls made on the main thread are still handed to the caller
+  // by libdbus instead of being taken off the queue by us.
+  io_queue = memnew(SPSCQueue<::DBusMessage *>(queue_size));
+  ::dbus_connection_add_filter(dbus_conn, io_filter, this, nullptr);
+  ::dbus_connection_set_dispatch_status_function(
+      dbus_conn, io_dispatch_status_changed, this, nullptr);
+  ::dbus_connection_set_wakeup_main_function(dbus_conn, io_wakeup_main, this,
+                                             nullptr);
 
-// Returns a uint32 value from the given int
-DBusUInt32 *DBus::uint32(int value) {
-  DBusUInt32 *dbus_value = memnew(DBusUInt32());
-  dbus_value->set_value(value);
+  io_running = true;
+  io_thread = std::thread(&DBus::io_thread_loop, this);
+
+  return godot::OK;
+}
+
+// Stops the background I/O thread. Any messages that were not popped are
+// discarded.
+void DBus::stop_io_thread() {
+  if (io_queue == nullptr) {
+    return;
+  }
+
+  io_running = false;
+  io_wake();
+  if (io_thread.joinable()) {
+    io_thread.join();
+  }
+
+  ::dbus_connection_set_wakeup_main_function(dbus_conn, nullptr, nullptr,
+                                             nullptr);
+  ::dbus_connection_set_dispatch_status_function(dbus_conn, nullptr, nullptr,
+                                                 nullptr);
+  ::dbus_connection_remove_filter(dbus_conn, io_filter, this);
+
+  ::DBusMessage *msg = nullptr;
+  while (io_queue->pop(msg)) {
+    ::dbus_message_unref(msg);
+  }
+  for (::DBusMessage *overflow_msg : io_overflow) {
+    ::dbus_message_unref(overflow_msg);
+  }
+  io_overflow.clear();
+  io_overflowed = false;
+  memdelete(io_queue);
+  io_queue = nullptr;
+  ::close(io_wake_fd);
+  io_wake_fd = -1;
+}
+
+// Returns true if the background I/O thread is running
+bool DBus::is_io_thread_running() { return io_running; }
+
+// Main loop of the background I/O thread
+void DBus::io_thread_loop() {
+  int conn_fd = -1;
+  if (!::dbus_connection_get_unix_fd(dbus_conn, &conn_fd)) {
+    io_running = false;
+    return;
+  }
+
+  while (io_running) {
+    // Dispatch anything that was already read (e.g. by a blocking call on
+    // another thread) before going to sleep.
+    {
+      std::lock_guard<std::mutex> lock(io_dispatch_mutex);
+      while (::dbus_connection_dispatch(dbus_conn) ==
+             DBUS_DISPATCH_DATA_REMAINS) {
+      }
+    }
+
+    struct pollfd fds[2];
+    fds[0].fd = conn_fd;
+    fds[0].events = POLLIN;
+    if (::dbus_connection_has_messages_to_send(dbus_conn)) {
+      fds[0].events |= POLLOUT;
+    }
+    fds[1].fd = io_wake_fd;
+    fds[1].events = POLLIN;
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // Any other error means the fds cannot be waited on anymore
+      io_running = false;
+      break;
+    }
+
+    // Reset the wakeup counter. EAGAIN only means it was already reset.
+    if (fds[1].revents & POLLIN) {
+      uint64_t count;
+      while (::read(io_wake_fd, &count, sizeof(count)) < 0 && errno == EINTR) {
+      }
+    }
+    if (!io_running) {
+      break;
+    }
+
+    // Non-blocking read/write now that the socket is ready
+    if (!::dbus_connection_read_write(dbus_conn, 0)) {
+      // The connection was closed
+      io_running = false;
+      break;
+    }
+  }
+}
+
+// Pushes a received message onto the queue. Takes ownership of the message.
+// If the main thread has fallen behind and the queue is full, messages spill
+// into a locked overflow list until it has caught up, so that the I/O thread
+// never blocks while dispatching.
+void DBus::io_enqueue(::DBusMessage *msg) {
+  if (!io_overflowed && io_queue->push(msg)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(io_overflow_mutex);
+  io_overflow.push_back(msg);
+  io_overflowed = true;
+}
+
+// Wakes the I/O thread up if it is blocked on the socket
+void DBus::io_wake() {
+  if (io_wake_fd < 0) {
+    return;
+  }
+  // EAGAIN means the counter is full, so a wakeup is already pending
+  uint64_t one = 1;
+  while (::write(io_wake_fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+}
+
+// Filter installed while the I/O thread is running that takes every message
+// that is not a reply to a blocking call.
+DBusHandlerResult DBus::io_filter(DBusConnection *conn, ::DBusMessage *msg,
+                                  void *user_data) {
+  DBus *dbus = (DBus *)user_data;
+  ::dbus_message_ref(msg);
+  dbus->io_enqueue(msg);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+// Called by libdbus when messages were queued by a thread other than the I/O
+// thread and need to be dispatched.
+void DBus::io_dispatch_status_changed(DBusConnection *conn,
+                                      DBusDispatchStatus status,
+                                      void *user_data) {
+  if (status == DBUS_DISPATCH_DATA_REMAINS) {
+    ((DBus *)user_data)->io_wake();
+  }
+}
+
+// Called by libdbus when outgoing messages were queued and need to be written
+void DBus::io_wakeup_main(void *user_data) { ((DBus *)user_data)->io_wake(); }
+
+// Called during dispatch on the I/O thread when the reply to an async call
+// arrives. The reply is queued like any other message so it reaches its
+// DBusPendingCall on the main thread.
+void DBus::io_pending_call_notify(::DBusPendingCall *pending,
+                                  void *user_data) {
+  ::DBusMessage *reply = ::dbus_pending_call_steal_reply(pending);
+  if (reply == nullptr) {
+    return;
+  }
+  ((DBus *)user_data)->io_enqueue(reply);
+}
+
+// Appends the elements of a packed array to the given array container if the
+// packed array matches the element type. Fixed size elements are copied with
+// a single call instead of one call per element. Returns false if the variant
+// needs to be appended element by element instead.
+static bool append_packed_array(DBusMessageIter *arr_iter, int element_type,
+                                const Variant &variant) {
+  switch (variant.get_type()) {
+  case Variant::PACKED_BYTE_ARRAY: {
+    if (element_type != DBUS_TYPE_BYTE) {
+      return false;
+    }
+    godot::PackedByteArray array = variant;
+    const uint8_t *data = array.ptr();
+    ::dbus_message_iter_append_fixed_array(arr_iter, DBUS_TYPE_BYTE, &data,
+                                           array.size());
+    return true;
+  }
+  case Variant::PACKED_INT32_ARRAY: {
+    if (element_type != DBUS_TYPE_INT32) {
+      return false;
+    }
+    godot::PackedInt32Array array = variant;
+    const int32_t *data = array.ptr();
+    ::dbus_message_iter_append_fixed_array(arr_iter, DBUS_TYPE_INT32, &data,
+                                           array.size());
+    return true;
+  }
+  case Variant::PACKED_INT64_ARRAY: {
+    if (element_type != DBUS_TYPE_INT64 && element_type != DBUS_TYPE_UINT64) {
+      return false;
+    }
+    godot::PackedInt64Array array = variant;
+    const int64_t *data = array.ptr();
+    ::dbus_message_iter_append_fixed_array(arr_iter, element_type, &data,
+                                           array.size());
+    return true;
+  }
+  case Variant::PACKED_FLOAT64_ARRAY: {
+    if (element_type != DBUS_TYPE_DOUBLE) {
+      return false;
+    }
+    godot::PackedFloat64Array array = variant;
+    const double *data = array.ptr();
+    ::dbus_message_iter_append_fixed_array(arr_iter, DBUS_TYPE_DOUBLE, &data,
+                                           array.size());
+    return true;
+  }
+  case Variant::PACKED_STRING_ARRAY: {
+    if (element_type != DBUS_TYPE_STRING &&
+        element_type != DBUS_TYPE_OBJECT_PATH &&
+        element_type != DBUS_TYPE_SIGNATURE) {
+      return false;
+    }
+    godot::PackedStringArray array = variant;
+    for (int i = 0; i < array.size(); i++) {
+      godot::CharString str = array[i].utf8();
+      const char *data = str.get_data();
+      ::dbus_message_iter_append_basic(arr_iter, element_type, &data);
+    }
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+// Appends a value of a basic type to the given iterator. Returns false if the
+// value cannot be marshaled as that type.
+static bool append_basic_arg(DBusMessageIter *iter, int arg_type,
+                             const Variant &variant) {
+  switch (arg_type) {
+  case DBUS_TYPE_STRING: {
+    godot::CharString arg = String(variant).utf8();
+    const char *data = arg.get_data();
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_STRING, &data);
+    return true;
+  }
+  case DBUS_TYPE_OBJECT_PATH: {
+    // libdbus aborts on invalid object paths, so check it first
+    godot::CharString arg = String(variant).utf8();
+    const char *data = arg.get_data();
+    if (!::dbus_validate_path(data, nullptr)) {
+      godot::UtilityFunctions::push_error("Invalid object path: ", variant);
+      return false;
+    }
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_OBJECT_PATH, &data);
+    return true;
+  }
+  case DBUS_TYPE_SIGNATURE: {
+    // libdbus aborts on invalid signatures, so check it first
+    godot::CharString arg = String(variant).utf8();
+    const char *data = arg.get_data();
+    if (!::dbus_signature_validate(data, nullptr)) {
+      godot::UtilityFunctions::push_error("Invalid signature: ", variant);
+      return false;
+    }
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_SIGNATURE, &data);
+    return true;
+  }
+  case DBUS_TYPE_BYTE: {
+    unsigned char arg = (unsigned char)(int64_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_BYTE, &arg);
+    return true;
+  }
+  case DBUS_TYPE_INT16: {
+    dbus_int16_t arg = (dbus_int16_t)(int64_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_INT16, &arg);
+    return true;
+  }
+  case DBUS_TYPE_UINT16: {
+    dbus_uint16_t arg = (dbus_uint16_t)(int64_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_UINT16, &arg);
+    return true;
+  }
+  case DBUS_TYPE_INT32: {
+    dbus_int32_t arg = (dbus_int32_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_INT32, &arg);
+    return true;
+  }
+  case DBUS_TYPE_UINT32: {
+    dbus_uint32_t arg = (dbus_uint32_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_UINT32, &arg);
+    return true;
+  }
+  case DBUS_TYPE_INT64: {
+    dbus_int64_t arg = (dbus_int64_t)(int64_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_INT64, &arg);
+    return true;
+  }
+  case DBUS_TYPE_UINT64: {
+    dbus_uint64_t arg = (dbus_uint64_t)(int64_t)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_UINT64, &arg);
+    return true;
+  }
+  case DBUS_TYPE_DOUBLE: {
+    double arg = (double)variant;
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_DOUBLE, &arg);
+    return true;
+  }
+  case DBUS_TYPE_BOOLEAN: {
+    dbus_bool_t arg = variant.booleanize();
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_BOOLEAN, &arg);
+    return true;
+  }
+  case DBUS_TYPE_UNIX_FD: {
+    // libdbus duplicates the descriptor when it is appended, so a wrapper
+    // keeps ownership of its own copy
+    int arg = (int)(int64_t)variant;
+    if (arg < 0) {
+      godot::UtilityFunctions::push_error("Invalid file descriptor: ",
+                                          variant);
+      return false;
+    }
+    ::dbus_message_iter_append_basic(iter, DBUS_TYPE_UNIX_FD, &arg);
+    return true;
+  }
+  default:
+    break;
+  }
+
+  char output[10];
+  sprintf(output, "%c", arg_type);
+  godot::UtilityFunctions::push_error("Invalid/unhandled argument type: ",
+                                      output);
+  return false;
+}
+
+// Appends a value boxed in a variant container with the given signature,
+// which must be a single complete type.
+static bool append_boxed_arg(DBusMessageIter *iter,
+                             const DBusSignaturePlan &plan,
+                             const Variant &variant) {
+  DBusMessageIter sub_iter;
+  ::dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT,
+                                     plan.signature.c_str(), &sub_iter);
+  if (!append_arg(&sub_iter, variant, plan, 0)) {
+    ::dbus_message_iter_abandon_container(iter, &sub_iter);
+    return false;
+  }
+  ::dbus_message_iter_close_container(iter, &sub_iter);
+  return true;
+}
+
+// Returns the compiled plan for one of the fixed signatures used when boxing
+// Godot values. These never change, so they are compiled once and kept for
+// the lifetime of the process.
+#define BOXED_PLAN(m_signature)                                                \
+  ([]() -> const DBusSignaturePlan & {                                         \
+    static std::shared_ptr<const DBusSignaturePlan> plan =                     \
+        DBusSignaturePlan::compile(m_signature);                               \
+    return *plan;                                                              \
+  }())
+
+// Appends the value of a typed wrapper as a DBus variant of the type given by
+// the wrapper's type tag
+static bool append_typed_variant_arg(DBusMessageIter *iter, DBusType *typed) {
+  switch (typed->get_type_code()) {
+  case DBUS_TYPE_BYTE:
+    return append_boxed_arg(iter, BOXED_PLAN("y"), typed->to_variant());
+  case DBUS_TYPE_INT16:
+    return append_boxed_arg(iter, BOXED_PLAN("n"), typed->to_variant());
+  case DBUS_TYPE_UINT16:
+    return append_boxed_arg(iter, BOXED_PLAN("q"), typed->to_variant());
+  case DBUS_TYPE_UINT32:
+    return append_boxed_arg(iter, BOXED_PLAN("u"), typed->to_variant());
+  case DBUS_TYPE_INT64:
+    return append_boxed_arg(iter, BOXED_PLAN("x"), typed->to_variant());
+  case DBUS_TYPE_UINT64:
+    return append_boxed_arg(iter, BOXED_PLAN("t"), typed->to_variant());
+  case DBUS_TYPE_OBJECT_PATH:
+    return append_boxed_arg(iter, BOXED_PLAN("o"), typed->to_variant());
+  case DBUS_TYPE_SIGNATURE:
+    return append_boxed_arg(iter, BOXED_PLAN("g"), typed->to_variant());
+  case DBUS_TYPE_UNIX_FD:
+    return append_boxed_arg(iter, BOXED_PLAN("h"), typed->to_variant());
+  case DBUS_TYPE_STRUCT: {
+    // The signature of a struct is only known at runtime, so its plan comes
+    // from the shared cache
+    DBusStruct *dbus_struct = (DBusStruct *)typed;
+    std::shared_ptr<const DBusSignaturePlan> plan =
+        DBusSignaturePlan::get(dbus_struct->get_signature());
+    if (plan == nullptr || plan->ops[0].type != DBUS_TYPE_STRUCT ||
+        plan->ops[0].next != (int)plan->ops.size()) {
+      godot::UtilityFunctions::push_error("Invalid struct signature: ",
+                                          dbus_struct->get_signature());
+      return false;
+    }
+    return append_boxed_arg(iter, *plan, dbus_struct->get_fields());
+  }
+  default:
+    break;
+  }
+
+  godot::UtilityFunctions::push_error("Invalid/unhandled Godot object type: ",
+                                      typed->get_class());
+  return false;
+}
+
+// Appends the given Godot value as a DBus variant, picking the contained type
+// from the type of the Godot value.
+static bool append_variant_arg(DBusMessageIter *iter, const Variant &variant) {
+  switch (variant.get_type()) {
+  case Variant::BOOL:
+    return append_boxed_arg(iter, BOXED_PLAN("b"), variant);
+  case Variant::INT: {
+    // Integers that do not fit in 32 bits are sent as int64
+    int64_t value = variant;
+    if (value < INT32_MIN || value > INT32_MAX) {
+      return append_boxed_arg(iter, BOXED_PLAN("x"), variant);
+    }
+    return append_boxed_arg(iter, BOXED_PLAN("i"), variant);
+  }
+  case Variant::FLOAT:
+    return append_boxed_arg(iter, BOXED_PLAN("d"), variant);
+  case Variant::STRING:
+  case Variant::STRING_NAME:
+    return append_boxed_arg(iter, BOXED_PLAN("s"), variant);
+  case Variant::DICTIONARY:
+    return append_boxed_arg(iter, BOXED_PLAN("a{sv}"), variant);
+  case Variant::ARRAY:
+    return append_boxed_arg(iter, BOXED_PLAN("av"), variant);
+  case Variant::PACKED_BYTE_ARRAY:
+    return append_boxed_arg(iter, BOXED_PLAN("ay"), variant);
+  case Variant::PACKED_INT32_ARRAY:
+    return append_boxed_arg(iter, BOXED_PLAN("ai"), variant);
+  case Variant::PACKED_INT64_ARRAY:
+    return append_boxed_arg(iter, BOXED_PLAN("ax"), variant);
+  case Variant::PACKED_FLOAT64_ARRAY:
+    return append_boxed_arg(iter, BOXED_PLAN("ad"), variant);
+  case Variant::PACKED_STRING_ARRAY:
+    return append_boxed_arg(iter, BOXED_PLAN("as"), variant);
+  case Variant::OBJECT: {
+    DBusType *typed =
+        godot::Object::cast_to<DBusType>((godot::Object *)variant);
+    if (typed == nullptr) {
+      break;
+    }
+    return append_typed_variant_arg(iter, typed);
+  }
+  default:
+    break;
+  }
+
+  godot::UtilityFunctions::push_error("Invalid/unhandled variant type: ",
+                                      variant.get_type());
+  return false;
+}
+
+// Appends the entries of a Godot dictionary as an array of dict entries.
+// The dictionary is walked with a variant iterator so no intermediate Array
+// of keys is built.
+static bool append_dictionary_arg(DBusMessageIter *arr_iter,
+                                  const Variant &variant,
+                                  const DBusSignaturePlan &plan,
+                                  int entry_index) {
+  const Dictionary dict = Dictionary(variant);
+  const int key_index = entry_index + 1;
+  const int value_index = plan.ops[key_index].next;
+
+  Variant it;
+  bool valid = false;
+  if (!variant.iter_init(it, valid) || !valid) {
+    return true;
+  }
+  do {
+    Variant key = variant.iter_get(it, valid);
+    DBusMessageIter entry_iter;
+    ::dbus_message_iter_open_container(arr_iter, DBUS_TYPE_DICT_ENTRY, nullptr,
+                                       &entry_iter);
+    if (!append_arg(&entry_iter, key, plan, key_index) ||
+        !append_arg(&entry_iter, dict[key], plan, value_index)) {
+      ::dbus_message_iter_abandon_container(arr_iter, &entry_iter);
+      return false;
+    }
+    ::dbus_message_iter_close_container(arr_iter, &entry_iter);
+  } while (variant.iter_next(it, valid) && valid);
+  return true;
+}
+
+// Appends the fields of a struct from a Godot array, one field per element
+static bool append_struct_arg(DBusMessageIter *iter, const Variant &variant,
+                              const DBusSignaturePlan &plan, int op_index) {
+  if (variant.get_type() != Variant::ARRAY) {
+    godot::UtilityFunctions::push_error(
+        "Passed struct signature without array argument");
+    return false;
+  }
+  const Array fields = Array(variant);
+
+  DBusMessageIter struct_iter;
+  ::dbus_message_iter_open_container(iter, DBUS_TYPE_STRUCT, nullptr,
+                                     &struct_iter);
+  int field = 0;
+  for (int child = op_index + 1; child < plan.ops[op_index].next;
+       child = plan.ops[child].next) {
+    if (field >= fields.size()) {
+      godot::UtilityFunctions::push_error(
+          "Not enough struct fields passed for signature: ",
+          plan.signature.c_str());
+      ::dbus_message_iter_abandon_container(iter, &struct_iter);
+      return false;
+    }
+    if (!append_arg(&struct_iter, fields[field++], plan, child)) {
+      ::dbus_message_iter_abandon_container(iter, &struct_iter);
+      return false;
+    }
+  }
+  ::dbus_message_iter_close_container(iter, &struct_iter);
+  return true;
+}
+
+// Sets the given argument on the DBusMessage with the given iterator. The
+// type of the argument is given by the op at "op_index" in the compiled
+// signature plan. Returns false if the value cannot be marshaled as that type,
+// in which case the message must not be sent.
+bool append_arg(DBusMessageIter *iter, const Variant &variant,
+                const DBusSignaturePlan &plan, int op_index) {
+  const DBusSignatureOp &op = plan.ops[op_index];
+
+  if (op.type == DBUS_TYPE_VARIANT) {
+    return append_variant_arg(iter, variant);
+  }
+
+  // Typed wrappers passed for an explicit signature are marshaled by value
+  if (variant.get_type() == Variant::OBJECT) {
+    DBusType *typed =
+        godot::Object::cast_to<DBusType>((godot::Object *)variant);
+    if (typed != nullptr) {
+      return append_arg(iter, typed->to_variant(), plan, op_index);
+    }
+  }
+
+  switch (op.type) {
+  case DBUS_TYPE_STRUCT:
+    return append_struct_arg(iter, variant, plan, op_index);
+  case DBUS_TYPE_ARRAY:
+    break;
+  default:
+    return append_basic_arg(iter, op.type, variant);
+  }
+
+  // Handle dictionaries. For DBus, a dictionary is an array of dict entries.
+  DBusMessageIter arr_iter;
+  if (op.element_type == DBUS_TYPE_DICT_ENTRY) {
+    // Ensure the passed variant is a dictionary
+    if (variant.get_type() != Variant::DICTIONARY) {
+      godot::UtilityFunctions::push_error(
+          "Passed dictionary signature without dictionary argument");
+      return false;
+    }
+    ::dbus_message_iter_open_container(
+        iter, DBUS_TYPE_ARRAY, op.element_signature.c_str(), &arr_iter);
+    if (!append_dictionary_arg(&arr_iter, variant, plan, op_index + 1)) {
+      ::dbus_message_iter_abandon_container(iter, &arr_iter);
+      return false;
+    }
+    ::dbus_message_iter_close_container(iter, &arr_iter);
+    return true;
+  }
+
+  // Handle regular arrays. The element type directly follows the array in the
+  // plan.
+  if (variant.get_type() < Variant::ARRAY) {
+    godot::UtilityFunctions::push_error(
+        "Passed array signature without array argument");
+    return false;
+  }
+  ::dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+                                     op.element_signature.c_str(), &arr_iter);
+
+  // Packed arrays of a matching type can be appended in one go
+  if (!append_packed_array(&arr_iter, op.element_type, variant)) {
+    // Convert the Godot Variant to a Godot Array
+    Array array = Array(variant);
+    for (int i = 0; i < array.size(); i++) {
+      if (!append_arg(&arr_iter, array[i], plan, op_index + 1)) {
+        ::dbus_message_iter_abandon_container(iter, &arr_iter);
+        return false;
+      }
+    }
+  }
+
+  // Close the array
+  ::dbus_message_iter_close_container(iter, &arr_iter);
+  return true;
+}
+
+// Builds a method call message with the given arguments marshaled according
+// to the given signature. Returns nullptr if the signature is invalid.
+::DBusMessage *build_method_call(String bus_name, String path, String iface,
+                                 String method, Array args, String signature) {
+  // Look up the compiled signature. This validates the signature the first
+  // time it is seen.
+  std::shared_ptr<const DBusSignaturePlan> plan =
+      DBusSignaturePlan::get(signature);
+  if (plan == nullptr) {
+    return nullptr;
+  }
+  return build_method_call(bus_name, path, iface, method, args, *plan);
+}
+
+// Builds a method call message with the given arguments marshaled according
+// to an already compiled signature. Returns nullptr if an argument cannot be
+// marshaled.
+::DBusMessage *build_method_call(String bus_name, String path, String iface,
+                                 String method, Array args,
+                                 const DBusSignaturePlan &plan) {
+  // Build the message to send
+  ::DBusMessage *msg = ::dbus_message_new_method_call(
+      bus_name.ascii().get_data(), path.ascii().get_data(),
+      iface.ascii().get_data(), method.ascii().get_data());
+
+  // Create an iterator to append arguments to the message
+  DBusMessageIter iter;
+  ::dbus_message_iter_init_append(msg, &iter);
+
+  // Add arguments to the message, walking the top level types of the plan
+  int op_index = 0;
+  for (int i = 0; i < args.size(); i++) {
+    if (op_index >= (int)plan.ops.size()) {
+      godot::UtilityFunctions::push_warning(
+          "More arguments passed than signature allows: ",
+          plan.signature.c_str());
+      break;
+    }
+    // TODO: validate Godot types match signature
+    if (!append_arg(&iter, args[i], plan, op_index)) {
+      godot::UtilityFunctions::push_error("Unable to marshal argument ", i,
+                                          " of ", iface, ".", method);
+      ::dbus_message_unref(msg);
+      return nullptr;
+    }
+    op_index = plan.ops[op_index].next;
+  }
+
+  return msg;
+}
+
+// Send the given message and wait for a reply
+DBusMessage *DBus::send_with_reply_and_block(String bus_name, String path,
+                                             String iface, String method,
+                                             Array args, String signature) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return nullptr;
+  }
+
+  // Build the message to send
+  ::DBusMessage *msg =
+      build_method_call(bus_name, path, iface, method, args, signature);
+  if (msg == nullptr) {
+    return nullptr;
+  }
+
+  return send_message_blocking(msg);
+};
+
+// Sends the given method call and waits for the reply. Takes ownership of
+// the message.
+DBusMessage *DBus::send_message_blocking(::DBusMessage *msg) {
+  // Create an initialize the error struct
+  DBusError dbus_error;
+  ::dbus_error_init(&dbus_error);
+
+  // Send the message and check for errors
+  uint64_t begin = 0;
+  if (stats != nullptr) {
+    stats->count_message(msg, true);
+    begin = godot::Time::get_singleton()->get_ticks_usec();
+  }
+  ::DBusMessage *reply = ::dbus_connection_send_with_reply_and_block(
+      dbus_conn, msg, DBUS_TIMEOUT_USE_DEFAULT, &dbus_error);
+  if (stats != nullptr) {
+    stats->blocking_usec.add(godot::Time::get_singleton()->get_ticks_usec() -
+                             begin);
+    if (reply != nullptr) {
+      stats->count_message(reply, false);
+    }
+  }
+  if (reply == nullptr) {
+    godot::UtilityFunctions::push_warning(
+        "Unable to send message ", ::dbus_message_get_interface(msg), ".",
+        ::dbus_message_get_member(msg), ": ", dbus_error.name, " ",
+        dbus_error.message);
+    ::dbus_error_free(&dbus_error);
+    ::dbus_message_unref(msg);
+    return nullptr;
+  }
+  ::dbus_error_free(&dbus_error);
+  ::dbus_message_unref(msg);
+
+  // Wrap the reply in a message object, reused from the pool if enabled
+  return wrap_message(reply);
+}
+
+// Send the given message without waiting for the reply. The returned pending
+// call emits "completed" once the reply arrives or the timeout expires, which
+// is checked whenever messages are read from the bus with pop_message. A
+// timeout of DBUS_TIMEOUT_USE_DEFAULT uses the libdbus default of 25 seconds,
+// and DBUS_TIMEOUT_INFINITE never times out.
+DBusPendingCall *DBus::send_async(String bus_name, String path, String iface,
+                                  String method, Array args, String signature,
+                                  int timeout_ms) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return nullptr;
+  }
+
+  // Build the message to send
+  ::DBusMessage *msg =
+      build_method_call(bus_name, path, iface, method, args, signature);
+  if (msg == nullptr) {
+    return nullptr;
+  }
+
+  return send_message_async(msg, timeout_ms);
+}
+
+// Sends the given method call without waiting for the reply and returns the
+// pending call tracking it. Takes ownership of the message.
+DBusPendingCall *DBus::send_message_async(::DBusMessage *msg, int timeout_ms) {
+  // Queue the message and get a libdbus pending call for its reply. The I/O
+  // thread must not dispatch until the notify function is set, otherwise the
+  // reply could be completed before we are listening for it.
+  if (stats != nullptr) {
+    stats->count_message(msg, true);
+  }
+  std::unique_lock<std::mutex> dispatch_lock(io_dispatch_mutex);
+  ::DBusPendingCall *pending = nullptr;
+  bool sent = ::dbus_connection_send_with_reply(dbus_conn, msg, &pending,
+                                                timeout_ms);
+  uint32_t serial = ::dbus_message_get_serial(msg);
+  if (!sent || pending == nullptr) {
+    godot::UtilityFunctions::push_warning(
+        "Unable to send message ", ::dbus_message_get_interface(msg), ".",
+        ::dbus_message_get_member(msg));
+    ::dbus_message_unref(msg);
+    if (pending != nullptr) {
+      ::dbus_pending_call_unref(pending);
+    }
+    return nullptr;
+  }
+  ::dbus_message_unref(msg);
+  ::dbus_pending_call_set_notify(pending, io_pending_call_notify, this,
+                                 nullptr);
+  dispatch_lock.unlock();
+  ::dbus_connection_flush(dbus_conn);
+
+  // Track the call so its reply can be routed to it
+  godot::Ref<DBusPendingCall> call;
+  call.instantiate();
+  call->pending = pending;
+  call->serial = serial;
+  if (timeout_ms == DBUS_TIMEOUT_USE_DEFAULT) {
+    timeout_ms = DEFAULT_TIMEOUT_MS;
+  }
+  if (timeout_ms != DBUS_TIMEOUT_INFINITE) {
+    call->deadline_usec = godot::Time::get_singleton()->get_ticks_usec() +
+                          (uint64_t)timeout_ms * 1000;
+  }
+  pending_calls.insert(serial, call);
+
+  return call.ptr();
+}
+
+// Send several independent method calls at once and wait for all of their
+// replies. Every call is queued before the connection is flushed a single
+// time, so the calls are in flight together and the total wait is close to a
+// single round trip. Each call is described by a Dictionary with the
+// "bus_name", "path", "iface", "method", "args" and "signature" of the call.
+// Returns an Array with the reply (or error reply) to each call in order, or
+// null for calls that could not be sent.
+Array DBus::send_batch(Array calls, int timeout_ms) {
+  Array replies = Array();
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return replies;
+  }
+  replies.resize(calls.size());
+
+  // Queue every message without flushing
+  godot::Vector<::DBusPendingCall *> pending_replies;
+  for (int i = 0; i < calls.size(); i++) {
+    pending_replies.push_back(nullptr);
+    Dictionary call = calls[i];
+    ::DBusMessage *msg = build_method_call(
+        call.get("bus_name", ""), call.get("path", ""), call.get("iface", ""),
+        call.get("method", ""), call.get("args", Array()),
+        call.get("signature", ""));
+    if (msg == nullptr) {
+      continue;
+    }
+    if (stats != nullptr) {
+      stats->count_message(msg, true);
+    }
+    ::DBusPendingCall *pending = nullptr;
+    if (!::dbus_connection_send_with_reply(dbus_conn, msg, &pending,
+                                           timeout_ms)) {
+      pending = nullptr;
+    }
+    ::dbus_message_unref(msg);
+    pending_replies.set(i, pending);
+  }
+  ::dbus_connection_flush(dbus_conn);
+
+  // Collect the replies. Blocking on one call queues any other reply that
+  // arrives meanwhile, so later calls are usually already complete. With the
+  // I/O thread running, the calls are completed by its dispatch instead.
+  for (int i = 0; i < pending_replies.size(); i++) {
+    ::DBusPendingCall *pending = pending_replies[i];
+    if (pending == nullptr) {
+      continue;
+    }
+    ::dbus_pending_call_block(pending);
+    ::DBusMessage *reply = ::dbus_pending_call_steal_reply(pending);
+    ::dbus_pending_call_unref(pending);
+    if (reply == nullptr) {
+      continue;
+    }
+    if (stats != nullptr) {
+      stats->count_message(reply, false);
+    }
+
+    // Wrap the reply in a message object, reused from the pool if enabled
+    replies[i] = wrap_message(reply);
+  }
+
+  return replies;
+}
+
+// Wraps the given message in a message object, reused from the pool if
+// enabled. The wrapper takes ownership of the message.
+DBusMessage *DBus::wrap_message(::DBusMessage *msg) {
+  DBusMessage *wrapper = message_pool.acquire(msg);
+  wrapper->stats = stats;
+  return wrapper;
+}
+
+// Routes a received message to any native consumer that is waiting for it.
+// Returns true if the message was consumed, in which case ownership of the
+// message has been taken.
+bool DBus::route_message(::DBusMessage *msg) {
+  int type = ::dbus_message_get_type(msg);
+
+  // Replayed method calls and replies belong to connections that are long
+  // gone. Only their signals are routed, so that recorded serials can never
+  // complete live pending calls and no replies are sent on their behalf.
+  if (type != DBUS_MESSAGE_TYPE_SIGNAL && replay_source.is_valid() &&
+      DBusReplaySource::is_replayed(msg)) {
+    return false;
+  }
+
+  // Method calls go to exported objects
+  if (type == DBUS_MESSAGE_TYPE_METHOD_CALL) {
+    if (object_table.is_empty()) {
+      return false;
+    }
+    return handle_method_call(msg);
+  }
+
+  // Signals go to any matching subscriptions
+  if (type == DBUS_MESSAGE_TYPE_SIGNAL) {
+    if (signal_table.is_empty()) {
+      return false;
+    }
+    bool replayed =
+        replay_source.is_valid() && DBusReplaySource::is_replayed(msg);
+    // Owner changes of tracked names are applied, but still reach scripts
+    // that asked for them with their own match rules
+    if (!replayed) {
+      signal_table.update_owner(msg);
+    }
+    godot::Vector<godot::Callable> callables;
+    signal_table.match(msg, !replayed, callables);
+    if (callables.is_empty()) {
+      return false;
+    }
+
+    // Create a new message object to contain the signal
+    godot::Ref<DBusMessage> signal = wrap_message(msg);
+    Array call_args = Array();
+    call_args.append(signal);
+    for (int i = 0; i < callables.size(); i++) {
+      if (callables[i].is_valid()) {
+        callables[i].callv(call_args);
+      }
+    }
+    call_args.clear();
+    message_pool.release(signal);
+    return true;
+  }
+
+  if (type != DBUS_MESSAGE_TYPE_METHOD_RETURN &&
+      type != DBUS_MESSAGE_TYPE_ERROR) {
+    return false;
+  }
+
+  // Replies to async method calls go to their pending call
+  uint32_t reply_serial = ::dbus_message_get_reply_serial(msg);
+  if (pending_calls.is_empty() || !pending_calls.has(reply_serial)) {
+    return false;
+  }
+  godot::Ref<DBusPendingCall> call = pending_calls[reply_serial];
+  pending_calls.erase(reply_serial);
+  if (!call->is_pending()) {
+    // Nobody is waiting for the reply to a cancelled call
+    drop_message(msg);
+    return true;
+  }
+  call->complete(msg);
+
+  return true;
+}
+
+// Drops a received message that reached neither a script nor a native
+// consumer, counting it in the stats
+void DBus::drop_message(::DBusMessage *msg) {
+  if (stats != nullptr) {
+    stats->messages_dropped++;
+    if (::dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_SIGNAL) {
+      stats->signals_dropped++;
+    }
+  }
+  ::dbus_message_unref(msg);
+}
+
+// Handles a method call for an exported object by invoking its handler with
+// the arguments of the call and sending back its return value. Returns false
+// if no object is exported at the path of the call.
+bool DBus::handle_method_call(::DBusMessage *msg) {
+  const DBusObjectMethod *found = nullptr;
+  DBusObjectTable::LookupResult result = object_table.lookup(msg, &found);
+
+  // The standard interfaces are answered unless the object exports its own
+  if (result != DBusObjectTable::LOOKUP_FOUND) {
+    if (::dbus_message_has_interface(msg, DBUS_INTERFACE_INTROSPECTABLE)) {
+      return handle_introspect(msg);
+    }
+    if (result != DBusObjectTable::LOOKUP_UNKNOWN_OBJECT &&
+        ::dbus_message_has_interface(msg, DBUS_INTERFACE_PROPERTIES)) {
+      return handle_properties_call(msg);
+    }
+  }
+  if (result == DBusObjectTable::LOOKUP_UNKNOWN_OBJECT) {
+    return false;
+  }
+  if (result == DBusObjectTable::LOOKUP_UNKNOWN_INTERFACE) {
+    send_error_reply(msg, DBUS_ERROR_UNKNOWN_INTERFACE, "No such interface");
+    ::dbus_message_unref(msg);
+    return true;
+  }
+  if (result == DBusObjectTable::LOOKUP_UNKNOWN_METHOD) {
+    send_error_reply(msg, DBUS_ERROR_UNKNOWN_METHOD, "No such method");
+    ::dbus_message_unref(msg);
+    return true;
+  }
+
+  // Copy the method, since the handler may change the exported objects
+  DBusObjectMethod method = *found;
+
+  // Create a new message object to contain the call
+  godot::Ref<DBusMessage> call;
+  call.instantiate();
+  call->message = msg;
+  call->stats = stats;
+  if (!method.callable.is_valid()) {
+    send_error_reply(msg, DBUS_ERROR_FAILED, "Method handler no longer exists");
+    return true;
+  }
+  Variant ret = method.callable.callv(call->get_args());
+  if (::dbus_message_get_no_reply(msg) || send_handler_error(msg, ret)) {
+    return true;
+  }
+
+  // Marshal the return value according to the reply signature. Multiple
+  // reply arguments are returned by the handler as an Array.
+  ::DBusMessage *reply = ::dbus_message_new_method_return(msg);
+  DBusMessageIter iter;
+  ::dbus_message_iter_init_append(reply, &iter);
+  const DBusSignaturePlan &plan = *method.out_plan;
+  int arg_count = plan.get_arg_count();
+  bool marshaled = true;
+  if (arg_count == 1) {
+    marshaled = append_arg(&iter, ret, plan, 0);
+  } else if (arg_count > 1) {
+    Array values = ret;
+    marshaled = values.size() >= arg_count;
+    int op_index = 0;
+    for (int i = 0; marshaled && i < arg_count; i++) {
+      marshaled = append_arg(&iter, values[i], plan, op_index);
+      op_index = plan.ops[op_index].next;
+    }
+  }
+
+  // Never send a reply that does not match the declared signature
+  if (!marshaled) {
+    ::dbus_message_unref(reply);
+    send_error_reply(msg, DBUS_ERROR_FAILED,
+                     "Method handler returned an invalid value");
+    return true;
+  }
+  send_reply(reply);
+
+  return true;
+}
+
+// Answers org.freedesktop.DBus.Properties calls on an exported object from
+// the getters and setters of its properties
+bool DBus::handle_properties_call(::DBusMessage *msg) {
+  const DBusObject *object =
+      object_table.find_object(::dbus_message_get_path(msg));
+
+  // Create a new message object to contain the call
+  godot::Ref<DBusMessage> call;
+  call.instantiate();
+  call->message = msg;
+  call->stats = stats;
+  Array args = call->get_args();
+  String iface_name = args.size() > 0 ? (String)args[0] : String();
+  const DBusObjectInterface *iface =
+      object->interfaces.getptr(godot::StringName(iface_name));
+  bool get_all = ::dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES,
+                                               "GetAll");
+  if (get_all) {
+    if (args.size() != 1 || args[0].get_type() != Variant::STRING) {
+      send_error_reply(msg, DBUS_ERROR_INVALID_ARGS, "Expected (s)");
+      return true;
+    }
+    if (iface == nullptr) {
+      send_error_reply(msg, DBUS_ERROR_UNKNOWN_INTERFACE, "No such interface");
+      return true;
+    }
+  }
+
+  // Get and Set address a single property
+  const DBusObjectProperty *property = nullptr;
+  bool get = ::dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES,
+                                           "Get");
+  bool set = ::dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES,
+                                           "Set");
+  if (get || set) {
+    if (args.size() != (get ? 2 : 3) ||
+        args[0].get_type() != Variant::STRING ||
+        args[1].get_type() != Variant::STRING) {
+      send_error_reply(msg, DBUS_ERROR_INVALID_ARGS,
+                       get ? "Expected (ss)" : "Expected (ssv)");
+      return true;
+    }
+    if (iface != nullptr) {
+      property = iface->properties.getptr(godot::StringName(args[1]));
+    }
+    if (property == nullptr) {
+      send_error_reply(msg, DBUS_ERROR_UNKNOWN_PROPERTY, "No such property");
+      return true;
+    }
+  } else if (!get_all) {
+    send_error_reply(msg, DBUS_ERROR_UNKNOWN_METHOD, "No such method");
+    return true;
+  }
+
+  // Copy the setter, since it may change the exported objects
+  if (set) {
+    godot::Callable setter = property->setter;
+    if (!setter.is_valid()) {
+      send_error_reply(msg, DBUS_ERROR_PROPERTY_READ_ONLY,
+                       "Property is read-only");
+      return true;
+    }
+    Array setter_args = Array();
+    setter_args.append(args[2]);
+    Variant ret = setter.callv(setter_args);
+    if (::dbus_message_get_no_reply(msg) || send_handler_error(msg, ret)) {
+      return true;
+    }
+    send_reply(::dbus_message_new_method_return(msg));
+    return true;
+  }
+
+  // Collect the values first, since getters may change the exported objects
+  godot::Vector<std::shared_ptr<const DBusSignaturePlan>> plans;
+  godot::PackedStringArray names;
+  Array values = Array();
+  if (get) {
+    plans.push_back(property->plan);
+    names.append(args[1]);
+    values.append(godot::Callable(property->getter).call());
+  } else {
+    for (const godot::KeyValue<godot::StringName, DBusObjectProperty> &entry :
+         iface->properties) {
+      plans.push_back(entry.value.plan);
+      names.append(entry.key);
+    }
+    Array getters = Array();
+    for (const godot::KeyValue<godot::StringName, DBusObjectProperty> &entry :
+         iface->properties) {
+      getters.append(entry.value.getter);
+    }
+    for (int i = 0; i < getters.size(); i++) {
+      values.append(godot::Callable(getters[i]).call());
+    }
+  }
+  if (::dbus_message_get_no_reply(msg)) {
+    return true;
+  }
+  for (int i = 0; i < values.size(); i++) {
+    if (send_handler_error(msg, values[i])) {
+      return true;
+    }
+  }
+
+  // Box every value in a variant of the property's type
+  ::DBusMessage *reply = ::dbus_message_new_method_return(msg);
+  DBusMessageIter iter;
+  DBusMessageIter arr_iter;
+  DBusMessageIter *values_iter = &iter;
+  ::dbus_message_iter_init_append(reply, &iter);
+  if (get_all) {
+    ::dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}",
+                                       &arr_iter);
+    values_iter = &arr_iter;
+  }
+  bool marshaled = true;
+  for (int i = 0; marshaled && i < values.size(); i++) {
+    DBusMessageIter entry_iter;
+    DBusMessageIter variant_iter;
+    DBusMessageIter *parent_iter = values_iter;
+    if (get_all) {
+      ::dbus_message_iter_open_container(values_iter, DBUS_TYPE_DICT_ENTRY,
+                                         nullptr, &entry_iter);
+      godot::CharString name = names[i].utf8();
+      const char *name_ptr = name.get_data();
+      ::dbus_message_iter_append_basic(&entry_iter, DBUS_TYPE_STRING,
+                                       &name_ptr);
+      parent_iter = &entry_iter;
+    }
+    ::dbus_message_iter_open_container(parent_iter, DBUS_TYPE_VARIANT,
+                                       plans[i]->signature.c_str(),
+                                       &variant_iter);
+    marshaled = append_arg(&variant_iter, values[i], *plans[i], 0);
+    if (!marshaled) {
+      ::dbus_message_iter_abandon_container(parent_iter, &variant_iter);
+      if (get_all) {
+        ::dbus_message_iter_abandon_container(values_iter, &entry_iter);
+      }
+      break;
+    }
+    ::dbus_message_iter_close_container(parent_iter, &variant_iter);
+    if (get_all) {
+      ::dbus_message_iter_close_container(values_iter, &entry_iter);
+    }
+  }
+  if (get_all) {
+    if (marshaled) {
+      ::dbus_message_iter_close_container(&iter, &arr_iter);
+    } else {
+      ::dbus_message_iter_abandon_container(&iter, &arr_iter);
+    }
+  }
+
+  // Never send a value that does not match the declared signature
+  if (!marshaled) {
+    ::dbus_message_unref(reply);
+    send_error_reply(msg, DBUS_ERROR_FAILED,
+                     "Property getter returned an invalid value");
+    return true;
+  }
+  send_reply(reply);
+
+  return true;
+}
+
+// Answers org.freedesktop.DBus.Introspectable calls for exported objects and
+// the paths above them. Returns false if nothing is exported at or below the
+// path of the call.
+bool DBus::handle_introspect(::DBusMessage *msg) {
+  String xml = object_table.introspect(::dbus_message_get_path(msg));
+  if (xml.is_empty()) {
+    return false;
+  }
+  if (!::dbus_message_is_method_call(msg, DBUS_INTERFACE_INTROSPECTABLE,
+                                     "Introspect")) {
+    send_error_reply(msg, DBUS_ERROR_UNKNOWN_METHOD, "No such method");
+    ::dbus_message_unref(msg);
+    return true;
+  }
+
+  ::DBusMessage *reply = ::dbus_message_new_method_return(msg);
+  godot::CharString data = xml.utf8();
+  const char *data_ptr = data.get_data();
+  ::dbus_message_append_args(reply, DBUS_TYPE_STRING, &data_ptr,
+                             DBUS_TYPE_INVALID);
+  send_reply(reply);
+  ::dbus_message_unref(msg);
+
+  return true;
+}
+
+// Sends an error reply if a handler returned a Dictionary with only an
+// "error_name" and an optional "error_message". Returns true if it did.
+bool DBus::send_handler_error(::DBusMessage *msg, const Variant &ret) {
+  if (ret.get_type() != Variant::DICTIONARY) {
+    return false;
+  }
+  Dictionary error = ret;
+  if (!error.has("error_name") ||
+      error.size() != (error.has("error_message") ? 2 : 1)) {
+    return false;
+  }
+
+  godot::CharString name = String(error["error_name"]).utf8();
+  godot::CharString text = String(error.get("error_message", "")).utf8();
+  if (!::dbus_validate_error_name(name.get_data(), nullptr)) {
+    godot::UtilityFunctions::push_warning(
+        "Invalid error name returned by method handler: ", error["error_name"]);
+    send_error_reply(msg, DBUS_ERROR_FAILED, text.get_data());
+    return true;
+  }
+  send_error_reply(msg, name.get_data(), text.get_data());
+
+  return true;
+}
+
+// Sends a reply to a method call and drops it
+void DBus::send_reply(::DBusMessage *reply) {
+  if (stats != nullptr) {
+    stats->count_message(reply, true);
+  }
+  ::dbus_connection_send(dbus_conn, reply, nullptr);
+  ::dbus_connection_flush(dbus_conn);
+  ::dbus_message_unref(reply);
+}
+
+// Sends an error reply to the given method call
+void DBus::send_error_reply(::DBusMessage *msg, const char *name,
+                            const char *text) {
+  if (::dbus_message_get_no_reply(msg)) {
+    return;
+  }
+  ::DBusMessage *reply = ::dbus_message_new_error(msg, name, text);
+  send_reply(reply);
+}
+
+// Times out any pending calls whose deadline has passed
+void DBus::expire_pending_calls() {
+  if (pending_calls.is_empty()) {
+    return;
+  }
+  uint64_t now = godot::Time::get_singleton()->get_ticks_usec();
+
+  godot::Vector<uint32_t> expired;
+  for (const godot::KeyValue<uint32_t, godot::Ref<DBusPendingCall>> &entry :
+       pending_calls) {
+    const godot::Ref<DBusPendingCall> &call = entry.value;
+    // Cancelled calls are kept until their deadline so that a late reply is
+    // still swallowed instead of being returned by pop_message.
+    if (call->state == DBusPendingCall::STATE_CANCELLED &&
+        call->deadline_usec == 0) {
+      call->deadline_usec = now + (uint64_t)DEFAULT_TIMEOUT_MS * 1000;
+    }
+    if (call->deadline_usec != 0 && now >= call->deadline_usec) {
+      expired.push_back(entry.key);
+    }
+  }
+
+  for (int i = 0; i < expired.size(); i++) {
+    godot::Ref<DBusPendingCall> call = pending_calls[expired[i]];
+    pending_calls.erase(expired[i]);
+    call->time_out();
+  }
+}
+
+// Return the unique name of the client on the bus.
+String DBus::get_unique_name() {
+  if (dbus_conn == nullptr) {
+    return String();
+  }
+  return String(::dbus_bus_get_unique_name(dbus_conn));
+}
+
+// Returns true if unix file descriptors can be sent over the connection. Not
+// all transports support passing descriptors.
+bool DBus::can_send_unix_fd() {
+  if (dbus_conn == nullptr) {
+    return false;
+  }
+  return ::dbus_connection_can_send_type(dbus_conn, DBUS_TYPE_UNIX_FD);
+}
+
+// Sets how many DBusMessage objects are kept for reuse. Received messages are
+// then wrapped in a pooled object that scripts no longer hold on to instead
+// of a newly allocated one. A pooled object drops its message once it is
+// reclaimed, at the latest a few reads after scripts let go of it. A size of
+// zero disables pooling.
+void DBus::set_message_pool_size(int size) { message_pool.set_capacity(size); }
+
+// Returns how many DBusMessage objects are kept for reuse
+int DBus::get_message_pool_size() { return message_pool.get_capacity(); }
+
+// Returns the hits, misses and hit rate of the message pool
+Dictionary DBus::get_message_pool_stats() { return message_pool.get_stats(); }
+
+// Starts writing every message received by this connection to a capture file
+// at the given path, which can later be replayed with a DBusReplaySource
+int DBus::start_capture(String path) {
+  stop_capture();
+  return capture.open(path);
+}
+
+// Stops writing received messages to the capture file and returns the number
+// of messages that were captured
+int DBus::stop_capture() {
+  int count = capture.message_count;
+  capture.close();
+  capture.message_count = 0;
+  return count;
+}
+
+// Returns whether received messages are being captured
+bool DBus::is_capturing() { return capture.file.is_valid(); }
+
+// Sets the source of replayed messages, which are received through
+// pop_message and dispatch ahead of any live traffic. A DBus object without a
+// connection can be used to replay captured signals to its subscriptions on
+// their own.
+void DBus::set_replay_source(Ref<DBusReplaySource> source) {
+  replay_source = source;
+}
+
+// Returns the source of replayed messages
+Ref<DBusReplaySource> DBus::get_replay_source() { return replay_source; }
+
+// Monitors added to the Performance singleton when stats monitors are enabled
+static const char *STATS_MONITORS[] = {
+    "messages_in", "messages_out",  "signals_dropped", "read_write_usec",
+    "decode_usec", "blocking_usec", "queue_depth"};
+
+// Enables or disables collecting runtime stats for this connection. Counting
+// bytes requires serializing every message, so it is only done on request.
+void DBus::set_stats_enabled(bool enabled, bool count_bytes) {
+  if (!enabled) {
+    set_stats_monitors_enabled(false);
+    stats.reset();
+    return;
+  }
+  if (stats == nullptr) {
+    stats = std::make_shared<DBusStats>();
+  }
+  stats->count_bytes = count_bytes;
+}
+
+// Returns whether runtime stats are being collected
+bool DBus::is_stats_enabled() { return stats != nullptr; }
+
+// Returns the collected runtime stats, or an empty dictionary if stats are
+// not enabled. Received messages are counted once they are taken off the
+// connection or the I/O thread's queue by pop_message, pop_messages or
+// dispatch, or returned to a blocking or batched call. Messages that were read
+// but not taken yet are not counted, and "queue_depth" shows that backlog for
+// the I/O thread. "messages_dropped" counts received messages that reached
+// neither a script nor a native consumer, like replies to cancelled calls.
+// "decode_usec" covers get_args, get_arg and get_value, including decoding the
+// arguments of calls to exported objects.
+Dictionary DBus::get_stats() {
+  if (stats == nullptr) {
+    return Dictionary();
+  }
+  return stats->to_dictionary();
+}
+
+// Clears the collected runtime stats
+void DBus::reset_stats() {
+  if (stats == nullptr) {
+    return;
+  }
+  bool count_bytes = stats->count_bytes;
+  *stats = DBusStats();
+  stats->count_bytes = count_bytes;
+}
+
+// Adds or removes custom monitors for the stats of this connection, so they
+// show up in the editor's debugger. Enabling monitors also enables stats.
+void DBus::set_stats_monitors_enabled(bool enabled) {
+  if (enabled == stats_monitors) {
+    return;
+  }
+  if (enabled && stats == nullptr) {
+    set_stats_enabled(true, false);
+  }
+  godot::Performance *performance = godot::Performance::get_singleton();
+  String prefix = "dbus/" + String::num_uint64(get_instance_id()) + "/";
+  for (const char *name : STATS_MONITORS) {
+    godot::StringName id = prefix + name;
+    if (enabled) {
+      godot::Callable monitor =
+          godot::Callable(this, "_get_stats_monitor").bind(String(name));
+      performance->add_custom_monitor(id, monitor);
+    } else if (performance->has_custom_monitor(id)) {
+      performance->remove_custom_monitor(id);
+    }
+  }
+  stats_monitors = enabled;
+}
+
+// Returns whether custom monitors are added for the stats of this connection
+bool DBus::is_stats_monitors_enabled() { return stats_monitors; }
+
+// Returns the current value of the given stats monitor. Histograms report
+// their total, except for the queue depth which reports the last sample.
+uint64_t DBus::_get_stats_monitor(String name) {
+  if (stats == nullptr) {
+    return 0;
+  }
+  if (name == "messages_in") {
+    return stats->messages_in;
+  }
+  if (name == "messages_out") {
+    return stats->messages_out;
+  }
+  if (name == "signals_dropped") {
+    return stats->signals_dropped;
+  }
+  if (name == "read_write_usec") {
+    return stats->read_write_usec.total;
+  }
+  if (name == "decode_usec") {
+    return stats->decode_usec.total;
+  }
+  if (name == "blocking_usec") {
+    return stats->blocking_usec.total;
+  }
+  if (name == "queue_depth") {
+    return stats->queue_depth.last;
+  }
+  return 0;
+}
+
+// Asks the bus whether the given name has an owner. This is a blocking round
+// trip; use watch_name to check a name repeatedly.
+bool DBus::name_has_owner(String name) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return false;
+  }
+
+  // Create an initialize the error struct
+  DBusError dbus_error;
+  ::dbus_error_init(&dbus_error);
+
+  bool ret = ::dbus_bus_name_has_owner(dbus_conn, name.ascii().get_data(),
+                                       &dbus_error);
+  if (::dbus_error_is_set(&dbus_error)) {
+    godot::UtilityFunctions::push_warning(
+        "Failed to see if name has owner: ", dbus_error.name, " ",
+        dbus_error.message);
+  }
+  dbus_error_free(&dbus_error);
+
+  return ret;
+};
+
+// Asks the bus to assign the given name to this connection by invoking the
+// RequestName method on the bus.
+int DBus::request_name(String name, unsigned int flags) {
+  if (dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CANT_CONNECT;
+  }
+
+  // Create an initialize the error struct
+  DBusError dbus_error;
+  ::dbus_error_init(&dbus_error);
+
+  int ret = ::dbus_bus_request_name(dbus_conn, name.ascii().get_data(), flags,
+                                    &dbus_error);
+  if (::dbus_error_is_set(&dbus_error)) {
+    godot::UtilityFunctions::push_warning(
+        "Failed to request name: ", dbus_error.name, " ", dbus_error.message);
+  }
+  dbus_error_free(&dbus_error);
+
+  return ret;
+};
+
+// Returns a uint32 value from the given int
+DBusUInt32 *DBus::uint32(int value) {
+  DBusUInt32 *dbus_value = memnew(DBusUInt32());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns an int16 value from the given int
+DBusInt16 *DBus::int16(int value) {
+  DBusInt16 *dbus_value = memnew(DBusInt16());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns a uint16 value from the given int
+DBusUInt16 *DBus::uint16(int value) {
+  DBusUInt16 *dbus_value = memnew(DBusUInt16());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns an int64 value from the given int
+DBusInt64 *DBus::int64(int64_t value) {
+  DBusInt64 *dbus_value = memnew(DBusInt64());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns a uint64 value from the given int, keeping its bit pattern
+DBusUInt64 *DBus::uint64(int64_t value) {
+  DBusUInt64 *dbus_value = memnew(DBusUInt64());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns a byte value from the given int
+DBusByte *DBus::byte(int value) {
+  DBusByte *dbus_value = memnew(DBusByte());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns an object path value from the given string
+DBusObjectPath *DBus::object_path(String value) {
+  DBusObjectPath *dbus_value = memnew(DBusObjectPath());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns a signature value from the given string
+DBusSignature *DBus::signature(String value) {
+  DBusSignature *dbus_value = memnew(DBusSignature());
+  dbus_value->set_value(value);
+
+  return dbus_value;
+}
+
+// Returns a struct value with the given signature, e.g. "(si)", and fields
+DBusStruct *DBus::structure(String signature, Array fields) {
+  DBusStruct *dbus_value = memnew(DBusStruct());
+  dbus_value->set_signature(signature);
+  dbus_value->set_fields(fields);
 
   return dbus_value;
 }
@@ -442,19 +2310,101 @@ void DBus::_bind_methods() {
   ClassDB::bind_method(D_METHOD("add_match", "rule"), &DBus::add_match);
   ClassDB::bind_method(D_METHOD("remove_match", "rule"), &DBus::remove_match);
   ClassDB::bind_method(D_METHOD("connect", "bus_type"), &DBus::connect);
+  ClassDB::bind_method(D_METHOD("connect_private", "bus_type"),
+                       &DBus::connect_private);
+  ClassDB::bind_method(D_METHOD("open_address", "address"),
+                       &DBus::open_address);
+  ClassDB::bind_method(D_METHOD("is_peer_to_peer"), &DBus::is_peer_to_peer);
   ClassDB::bind_method(D_METHOD("get_unique_name"), &DBus::get_unique_name);
   ClassDB::bind_method(D_METHOD("request_name", "name", "flags"),
                        &DBus::request_name);
   ClassDB::bind_method(D_METHOD("name_has_owner", "name"),
                        &DBus::name_has_owner);
+  ClassDB::bind_method(D_METHOD("can_send_unix_fd"), &DBus::can_send_unix_fd);
+  ClassDB::bind_method(D_METHOD("set_message_pool_size", "size"),
+                       &DBus::set_message_pool_size);
+  ClassDB::bind_method(D_METHOD("get_message_pool_size"),
+                       &DBus::get_message_pool_size);
+  ClassDB::bind_method(D_METHOD("get_message_pool_stats"),
+                       &DBus::get_message_pool_stats);
+  ClassDB::bind_method(D_METHOD("start_capture", "path"), &DBus::start_capture);
+  ClassDB::bind_method(D_METHOD("stop_capture"), &DBus::stop_capture);
+  ClassDB::bind_method(D_METHOD("is_capturing"), &DBus::is_capturing);
+  ClassDB::bind_method(D_METHOD("set_replay_source", "source"),
+                       &DBus::set_replay_source);
+  ClassDB::bind_method(D_METHOD("get_replay_source"),
+                       &DBus::get_replay_source);
+  ClassDB::bind_method(D_METHOD("set_stats_enabled", "enabled", "count_bytes"),
+                       &DBus::set_stats_enabled, DEFVAL(false));
+  ClassDB::bind_method(D_METHOD("is_stats_enabled"), &DBus::is_stats_enabled);
+  ClassDB::bind_method(D_METHOD("get_stats"), &DBus::get_stats);
+  ClassDB::bind_method(D_METHOD("reset_stats"), &DBus::reset_stats);
+  ClassDB::bind_method(D_METHOD("set_stats_monitors_enabled", "enabled"),
+                       &DBus::set_stats_monitors_enabled);
+  ClassDB::bind_method(D_METHOD("is_stats_monitors_enabled"),
+                       &DBus::is_stats_monitors_enabled);
+  ClassDB::bind_method(D_METHOD("_get_stats_monitor", "name"),
+                       &DBus::_get_stats_monitor);
+  ClassDB::bind_method(D_METHOD("subscribe", "sender", "path", "iface",
+                                "member", "callable", "arg0"),
+                       &DBus::subscribe, DEFVAL(""));
+  ClassDB::bind_method(D_METHOD("unsubscribe", "id"), &DBus::unsubscribe);
+  ClassDB::bind_method(D_METHOD("dispatch", "max_count"), &DBus::dispatch,
+                       DEFVAL(1024));
+  ClassDB::bind_method(
+      D_METHOD("create_property_cache", "bus_name", "path", "iface"),
+      &DBus::create_property_cache);
+  ClassDB::bind_method(
+      D_METHOD("create_object_manager_mirror", "bus_name", "path"),
+      &DBus::create_object_manager_mirror, DEFVAL("/"));
+  ClassDB::bind_method(D_METHOD("create_event_loop"),
+                       &DBus::create_event_loop);
+  ClassDB::bind_method(D_METHOD("watch_name", "name"), &DBus::watch_name);
+  ClassDB::bind_method(D_METHOD("create_proxy", "bus_name", "path"),
+                       &DBus::create_proxy);
+  ClassDB::bind_method(D_METHOD("clear_introspection_cache"),
+                       &DBus::clear_introspection_cache);
+  ClassDB::bind_method(
+      D_METHOD("register_object", "path", "iface", "handlers", "properties"),
+      &DBus::register_object, DEFVAL(Dictionary()));
+  ClassDB::bind_method(D_METHOD("unregister_object", "path", "iface"),
+                       &DBus::unregister_object, DEFVAL(""));
+  ClassDB::bind_method(D_METHOD("send_batch", "calls", "timeout_ms"),
+                       &DBus::send_batch, DEFVAL(DBUS_TIMEOUT_USE_DEFAULT));
   ClassDB::bind_method(D_METHOD("pop_message"), &DBus::pop_message);
+  ClassDB::bind_method(D_METHOD("pop_messages", "max_count", "time_budget_usec"),
+                       &DBus::pop_messages, DEFVAL(0));
+  ClassDB::bind_method(D_METHOD("start_io_thread", "queue_size"),
+                       &DBus::start_io_thread, DEFVAL(4096));
+  ClassDB::bind_method(D_METHOD("stop_io_thread"), &DBus::stop_io_thread);
+  ClassDB::bind_method(D_METHOD("is_io_thread_running"),
+                       &DBus::is_io_thread_running);
   ClassDB::bind_method(D_METHOD("send_with_reply_and_block", "bus_name", "path",
                                 "iface", "method", "args", "signature"),
                        &DBus::send_with_reply_and_block);
+  ClassDB::bind_method(D_METHOD("send_async", "bus_name", "path", "iface",
+                                "method", "args", "signature", "timeout_ms"),
+                       &DBus::send_async, DEFVAL(DBUS_TIMEOUT_USE_DEFAULT));
 
   // Type constructors
   ClassDB::bind_static_method("DBus", D_METHOD("uint32", "value"),
                               &DBus::uint32);
+  ClassDB::bind_static_method("DBus", D_METHOD("int16", "value"),
+                              &DBus::int16);
+  ClassDB::bind_static_method("DBus", D_METHOD("uint16", "value"),
+                              &DBus::uint16);
+  ClassDB::bind_static_method("DBus", D_METHOD("int64", "value"),
+                              &DBus::int64);
+  ClassDB::bind_static_method("DBus", D_METHOD("uint64", "value"),
+                              &DBus::uint64);
+  ClassDB::bind_static_method("DBus", D_METHOD("byte", "value"), &DBus::byte);
+  ClassDB::bind_static_method("DBus", D_METHOD("object_path", "value"),
+                              &DBus::object_path);
+  ClassDB::bind_static_method("DBus", D_METHOD("signature", "value"),
+                              &DBus::signature);
+  ClassDB::bind_static_method("DBus",
+                              D_METHOD("structure", "signature", "fields"),
+                              &DBus::structure);
 
   // Constants
   BIND_CONSTANT(DBUS_BUS_SESSION);
@@ -467,4 +2417,6 @@ void DBus::_bind_methods() {
   BIND_CONSTANT(DBUS_REQUEST_NAME_REPLY_IN_QUEUE);
   BIND_CONSTANT(DBUS_REQUEST_NAME_REPLY_EXISTS);
   BIND_CONSTANT(DBUS_REQUEST_NAME_REPLY_ALREADY_OWNER);
+  BIND_CONSTANT(DBUS_TIMEOUT_USE_DEFAULT);
+  BIND_CONSTANT(DBUS_TIMEOUT_INFINITE);
 };
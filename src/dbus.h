@@ -5,11 +5,20 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <atomic>
 #include <dbus/dbus.h>
+#include <deque>
+#include <memory>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/templates/vector.hpp"
 #include "godot_cpp/variant/array.hpp"
+#include "godot_cpp/variant/callable.hpp"
 #include "godot_cpp/variant/packed_byte_array.hpp"
 #include "godot_cpp/variant/packed_string_array.hpp"
 #include "godot_cpp/variant/string.hpp"
@@ -19,17 +28,99 @@
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
+#include "dbus_capture.h"
+#include "dbus_introspection.h"
 #include "dbus_message.h"
+#include "dbus_message_pool.h"
+#include "dbus_object_table.h"
+#include "dbus_pending_call.h"
+#include "dbus_replay_source.h"
+#include "dbus_signal_table.h"
+#include "dbus_signature_plan.h"
+#include "dbus_stats.h"
 #include "dbus_types.h"
+#include "spsc_queue.h"
+
+class DBusEventLoop;
+class DBusObjectManagerMirror;
+class DBusPropertyCache;
+class DBusNameWatcher;
+class DBusProxy;
 
 class DBus : public godot::RefCounted {
   GDCLASS(DBus, godot::RefCounted);
+  friend class DBusEventLoop;
+  friend class DBusProxy;
 
 protected:
   static void _bind_methods();
 
 private:
   DBusConnection *dbus_conn = nullptr;
+  bool private_conn = false;
+  bool peer_conn = false;
+  godot::HashMap<uint32_t, godot::Ref<DBusPendingCall>> pending_calls;
+  DBusSignalTable signal_table;
+  DBusObjectTable object_table;
+  DBusMessagePool message_pool;
+
+  // Runtime stats, only allocated while enabled. Shared with the messages
+  // wrapped by this connection so they can record their decode time.
+  std::shared_ptr<DBusStats> stats;
+  bool stats_monitors = false;
+
+  // Traffic capture and replay
+  DBusCapture capture;
+  godot::Ref<DBusReplaySource> replay_source;
+
+  // Parsed introspection data by bus name and path
+  godot::HashMap<godot::String, std::shared_ptr<const DBusIntrospection>>
+      introspection_cache;
+
+  // Background I/O thread state
+  std::thread io_thread;
+  std::atomic<bool> io_running{false};
+  SPSCQueue<::DBusMessage *> *io_queue = nullptr;
+  int io_wake_fd = -1;
+  std::mutex io_dispatch_mutex;
+  std::mutex io_overflow_mutex;
+  std::deque<::DBusMessage *> io_overflow;
+  std::atomic<bool> io_overflowed{false};
+
+  // Set while a DBusEventLoop does the I/O for the connection
+  bool event_loop_attached = false;
+
+  void read_available();
+  void track_owner(const godot::String &sender);
+  ::DBusMessage *next_message();
+  ::DBusMessage *take_message();
+  DBusMessage *wrap_message(::DBusMessage *msg);
+  bool route_message(::DBusMessage *msg);
+  void drop_message(::DBusMessage *msg);
+  bool handle_method_call(::DBusMessage *msg);
+  bool handle_properties_call(::DBusMessage *msg);
+  bool handle_introspect(::DBusMessage *msg);
+  bool send_handler_error(::DBusMessage *msg, const godot::Variant &ret);
+  DBusMessage *send_message_blocking(::DBusMessage *msg);
+  DBusPendingCall *send_message_async(::DBusMessage *msg, int timeout_ms);
+  std::shared_ptr<const DBusIntrospection> introspect(godot::String bus_name,
+                                                      godot::String path);
+  void send_reply(::DBusMessage *reply);
+  void send_error_reply(::DBusMessage *msg, const char *name,
+                        const char *text);
+  void expire_pending_calls();
+  uint64_t get_next_deadline_usec();
+  void io_thread_loop();
+  void io_enqueue(::DBusMessage *msg);
+  void io_wake();
+  static DBusHandlerResult io_filter(DBusConnection *conn, ::DBusMessage *msg,
+                                     void *user_data);
+  static void io_dispatch_status_changed(DBusConnection *conn,
+                                         DBusDispatchStatus status,
+                                         void *user_data);
+  static void io_wakeup_main(void *user_data);
+  static void io_pending_call_notify(::DBusPendingCall *pending,
+                                     void *user_data);
 
 public:
   // Constructor/deconstructor
@@ -40,20 +131,81 @@ public:
   int add_match(godot::String match);
   int remove_match(godot::String match);
   int connect(int bus_type);
+  int connect_private(int bus_type);
+  int open_address(godot::String address);
+  bool is_peer_to_peer();
   godot::String get_unique_name();
   DBusMessage *pop_message();
+  godot::Array pop_messages(int max_count, int time_budget_usec);
+  int start_io_thread(int queue_size);
+  void stop_io_thread();
+  bool is_io_thread_running();
   bool name_has_owner(godot::String name);
+  bool can_send_unix_fd();
+  void set_message_pool_size(int size);
+  int get_message_pool_size();
+  godot::Dictionary get_message_pool_stats();
+  int start_capture(godot::String path);
+  int stop_capture();
+  bool is_capturing();
+  void set_replay_source(godot::Ref<DBusReplaySource> source);
+  godot::Ref<DBusReplaySource> get_replay_source();
+  void set_stats_enabled(bool enabled, bool count_bytes);
+  bool is_stats_enabled();
+  godot::Dictionary get_stats();
+  void reset_stats();
+  void set_stats_monitors_enabled(bool enabled);
+  bool is_stats_monitors_enabled();
+  uint64_t _get_stats_monitor(godot::String name);
   int request_name(godot::String name, unsigned int flags);
+  int subscribe(godot::String sender, godot::String path, godot::String iface,
+                godot::String member, godot::Callable callable,
+                godot::String arg0 = godot::String());
+  int unsubscribe(int id);
+  int dispatch(int max_count);
+  int register_object(godot::String path, godot::String iface,
+                      godot::Dictionary handlers,
+                      godot::Dictionary properties = godot::Dictionary());
+  int unregister_object(godot::String path, godot::String iface);
+  DBusPropertyCache *create_property_cache(godot::String bus_name,
+                                           godot::String path,
+                                           godot::String iface);
+  DBusObjectManagerMirror *
+  create_object_manager_mirror(godot::String bus_name, godot::String path);
+  DBusEventLoop *create_event_loop();
+  DBusNameWatcher *watch_name(godot::String name);
+  DBusProxy *create_proxy(godot::String bus_name, godot::String path);
+  void clear_introspection_cache();
   DBusMessage *
   send_with_reply_and_block(godot::String bus_name, godot::String path,
                             godot::String iface, godot::String method,
                             godot::Array args, godot::String signature);
+  DBusPendingCall *send_async(godot::String bus_name, godot::String path,
+                              godot::String iface, godot::String method,
+                              godot::Array args, godot::String signature,
+                              int timeout_ms);
+  godot::Array send_batch(godot::Array calls, int timeout_ms);
 
   // Methods that convert types
   static DBusUInt32 *uint32(int value);
+  static DBusInt16 *int16(int value);
+  static DBusUInt16 *uint16(int value);
+  static DBusInt64 *int64(int64_t value);
+  static DBusUInt64 *uint64(int64_t value);
+  static DBusByte *byte(int value);
+  static DBusObjectPath *object_path(godot::String value);
+  static DBusSignature *signature(godot::String value);
+  static DBusStruct *structure(godot::String signature, godot::Array fields);
 };
 
-void append_arg(DBusMessageIter *iter, godot::Variant variant,
-                DBusSignatureIter *sig_iter);
+bool append_arg(DBusMessageIter *iter, const godot::Variant &variant,
+                const DBusSignaturePlan &plan, int op_index);
+::DBusMessage *build_method_call(godot::String bus_name, godot::String path,
+                                 godot::String iface, godot::String method,
+                                 godot::Array args, godot::String signature);
+::DBusMessage *build_method_call(godot::String bus_name, godot::String path,
+                                 godot::String iface, godot::String method,
+                                 godot::Array args,
+                                 const DBusSignaturePlan &plan);
 
 #endif // DBUS_CLASS_H
@@ -0,0 +1,59 @@
+#include "dbus_capture.h"
+
+#include <cstring>
+
+#include "godot_cpp/classes/time.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/utility_functions.hpp"
+
+using godot::FileAccess;
+using godot::PackedByteArray;
+using godot::String;
+
+// Creates the capture file at the given path and writes its header
+int DBusCapture::open(String path) {
+  file = FileAccess::open(path, FileAccess::WRITE);
+  if (file.is_null()) {
+    godot::UtilityFunctions::push_error("Unable to create capture file: ",
+                                        path);
+    return FileAccess::get_open_error();
+  }
+
+  PackedByteArray magic;
+  magic.resize(DBUS_CAPTURE_MAGIC_LENGTH);
+  memcpy(magic.ptrw(), DBUS_CAPTURE_MAGIC, DBUS_CAPTURE_MAGIC_LENGTH);
+  file->store_buffer(magic);
+  file->store_32(DBUS_CAPTURE_VERSION);
+
+  start_usec = godot::Time::get_singleton()->get_ticks_usec();
+  message_count = 0;
+  return godot::OK;
+}
+
+// Appends a record for the given message to the capture file
+void DBusCapture::write(::DBusMessage *msg) {
+  char *data = nullptr;
+  int size = 0;
+  if (!::dbus_message_marshal(msg, &data, &size)) {
+    return;
+  }
+
+  PackedByteArray bytes;
+  bytes.resize(size);
+  memcpy(bytes.ptrw(), data, size);
+  ::dbus_free(data);
+
+  file->store_64(godot::Time::get_singleton()->get_ticks_usec() - start_usec);
+  file->store_32(size);
+  file->store_buffer(bytes);
+  message_count++;
+}
+
+// Flushes and closes the capture file
+void DBusCapture::close() {
+  if (file.is_null()) {
+    return;
+  }
+  file->close();
+  file.unref();
+}
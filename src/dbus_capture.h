@@ -0,0 +1,32 @@
+#ifndef DBUS_CAPTURE_H
+#define DBUS_CAPTURE_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+
+#include "godot_cpp/classes/file_access.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/variant/string.hpp"
+
+// Capture files start with a magic string and a format version, followed by
+// one record per message:
+//   uint64  microseconds since the capture was started
+//   uint32  length of the message in bytes
+//   bytes   the message as serialized by dbus_message_marshal
+// All integers are little endian.
+#define DBUS_CAPTURE_MAGIC "GDBUSCAP"
+#define DBUS_CAPTURE_MAGIC_LENGTH 8
+#define DBUS_CAPTURE_VERSION 1
+
+// Writes the messages received by a connection to a capture file
+struct DBusCapture {
+  godot::Ref<godot::FileAccess> file;
+  uint64_t start_usec = 0;
+  uint64_t message_count = 0;
+
+  int open(godot::String path);
+  void write(::DBusMessage *msg);
+  void close();
+};
+
+#endif // DBUS_CAPTURE_H
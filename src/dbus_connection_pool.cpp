@@ -0,0 +1,87 @@
+#include "dbus_connection_pool.h"
+
+using godot::Array;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Ref;
+using godot::String;
+
+DBusConnectionPool::DBusConnectionPool(){};
+DBusConnectionPool::~DBusConnectionPool(){};
+
+// Opens "size" private connections to the given message bus
+int DBusConnectionPool::open(int bus_type, int size) {
+  if (!connections.is_empty()) {
+    godot::UtilityFunctions::push_error("Connection pool is already open");
+    return godot::ERR_ALREADY_IN_USE;
+  }
+  if (size < 1) {
+    godot::UtilityFunctions::push_error("Invalid connection pool size: ",
+                                        size);
+    return godot::ERR_INVALID_PARAMETER;
+  }
+
+  for (int i = 0; i < size; i++) {
+    Ref<DBus> connection;
+    connection.instantiate();
+    int err = connection->connect_private(bus_type);
+    if (err != godot::OK) {
+      connections.clear();
+      return err;
+    }
+    connections.push_back(connection);
+  }
+
+  return godot::OK;
+}
+
+// Drops the pool's references to its connections. Each connection is closed
+// once nothing else references it.
+void DBusConnectionPool::close() { connections.clear(); }
+
+// Returns the number of connections in the pool
+int DBusConnectionPool::get_size() { return connections.size(); }
+
+// Returns the connection for the subsystem with the given name. The same name
+// always maps to the same connection.
+DBus *DBusConnectionPool::get_connection(String key) {
+  if (connections.is_empty()) {
+    godot::UtilityFunctions::push_error("Connection pool is not open");
+    return nullptr;
+  }
+  int index = key.hash() % (uint32_t)connections.size();
+  return connections[index].ptr();
+}
+
+// Returns all connections in the pool
+Array DBusConnectionPool::get_connections() {
+  Array result = Array();
+  for (int i = 0; i < connections.size(); i++) {
+    result.append(connections[i]);
+  }
+  return result;
+}
+
+// Dispatches up to "max_count" messages on each connection in the pool and
+// returns the total number dispatched
+int DBusConnectionPool::dispatch(int max_count) {
+  int dispatched = 0;
+  for (int i = 0; i < connections.size(); i++) {
+    dispatched += connections[i]->dispatch(max_count);
+  }
+  return dispatched;
+}
+
+// Register the methods with Godot
+void DBusConnectionPool::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("open", "bus_type", "size"),
+                       &DBusConnectionPool::open);
+  ClassDB::bind_method(D_METHOD("close"), &DBusConnectionPool::close);
+  ClassDB::bind_method(D_METHOD("get_size"), &DBusConnectionPool::get_size);
+  ClassDB::bind_method(D_METHOD("get_connection", "key"),
+                       &DBusConnectionPool::get_connection);
+  ClassDB::bind_method(D_METHOD("get_connections"),
+                       &DBusConnectionPool::get_connections);
+  ClassDB::bind_method(D_METHOD("dispatch", "max_count"),
+                       &DBusConnectionPool::dispatch, DEFVAL(1024));
+};
@@ -0,0 +1,44 @@
+#ifndef DBUS_CONNECTION_POOL_CLASS_H
+#define DBUS_CONNECTION_POOL_CLASS_H
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/templates/vector.hpp"
+#include "godot_cpp/variant/array.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "dbus.h"
+
+// Fixed set of private connections to one message bus. Independent
+// subsystems ask for a connection by name and always get the same one, so
+// their traffic is spread over several sockets and queues instead of all
+// going through the connection shared by the process. Each connection has
+// to be pumped, e.g. with dispatch or by starting its I/O thread.
+class DBusConnectionPool : public godot::RefCounted {
+  GDCLASS(DBusConnectionPool, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::Vector<godot::Ref<DBus>> connections;
+
+public:
+  // Constructor/deconstructor
+  DBusConnectionPool();
+  ~DBusConnectionPool();
+
+  // Methods
+  int open(int bus_type, int size);
+  void close();
+  int get_size();
+  DBus *get_connection(godot::String key);
+  godot::Array get_connections();
+  int dispatch(int max_count);
+};
+
+#endif // DBUS_CONNECTION_POOL_CLASS_H
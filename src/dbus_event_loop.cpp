@@ -0,0 +1,398 @@
+#include "dbus_event_loop.h"
+#include "dbus.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "godot_cpp/classes/time.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+
+// Maximum number of events collected by a single epoll_wait
+static const int MAX_EVENTS = 16;
+
+// Returns the current time on the clock used for all deadlines
+static uint64_t now_usec() {
+  return godot::Time::get_singleton()->get_ticks_usec();
+}
+
+// Converts libdbus watch flags to epoll events
+static uint32_t watch_flags_to_events(unsigned int flags) {
+  uint32_t events = 0;
+  if (flags & DBUS_WATCH_READABLE) {
+    events |= EPOLLIN;
+  }
+  if (flags & DBUS_WATCH_WRITABLE) {
+    events |= EPOLLOUT;
+  }
+  return events;
+}
+
+// Converts epoll events to libdbus watch flags
+static unsigned int events_to_watch_flags(uint32_t events) {
+  unsigned int flags = 0;
+  if (events & EPOLLIN) {
+    flags |= DBUS_WATCH_READABLE;
+  }
+  if (events & EPOLLOUT) {
+    flags |= DBUS_WATCH_WRITABLE;
+  }
+  if (events & EPOLLERR) {
+    flags |= DBUS_WATCH_ERROR;
+  }
+  if (events & EPOLLHUP) {
+    flags |= DBUS_WATCH_HANGUP;
+  }
+  return flags;
+}
+
+DBusEventLoop::DBusEventLoop(){};
+DBusEventLoop::~DBusEventLoop() { stop(); };
+
+// Hooks the loop into the connection and starts the thread waiting for events
+int DBusEventLoop::start() {
+  if (dbus.is_null() || dbus->dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CONNECTION_ERROR;
+  }
+  if (running) {
+    return godot::ERR_ALREADY_IN_USE;
+  }
+  if (dbus->io_queue != nullptr || dbus->event_loop_attached) {
+    godot::UtilityFunctions::push_error(
+        "The connection is already pumped by another thread or event loop");
+    return godot::ERR_ALREADY_IN_USE;
+  }
+
+  epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+  wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd < 0 || wake_fd < 0) {
+    godot::UtilityFunctions::push_error("Unable to create event loop fds");
+    stop();
+    return godot::ERR_CANT_CREATE;
+  }
+  struct epoll_event wake_event = {};
+  wake_event.events = EPOLLIN;
+  wake_event.data.fd = wake_fd;
+  ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &wake_event);
+
+  // libdbus immediately reports its existing watches and timeouts
+  DBusConnection *conn = dbus->dbus_conn;
+  running = true;
+  dbus->event_loop_attached = true;
+  if (!::dbus_connection_set_watch_functions(conn, add_watch, remove_watch,
+                                             toggle_watch, this, nullptr) ||
+      !::dbus_connection_set_timeout_functions(
+          conn, add_timeout, remove_timeout, toggle_timeout, this, nullptr)) {
+    stop();
+    return godot::ERR_OUT_OF_MEMORY;
+  }
+  ::dbus_connection_set_dispatch_status_function(conn, dispatch_status_changed,
+                                                 this, nullptr);
+
+  update_deadline();
+  wait_thread = std::thread(&DBusEventLoop::wait_thread_loop, this);
+
+  // Messages may already be waiting from before the loop was started
+  if (::dbus_connection_get_dispatch_status(conn) ==
+      DBUS_DISPATCH_DATA_REMAINS) {
+    schedule_wake();
+  }
+
+  return godot::OK;
+}
+
+// Stops the loop and hands the connection back to polling
+void DBusEventLoop::stop() {
+  if (running) {
+    running = false;
+    notify_wait_thread();
+    if (wait_thread.joinable()) {
+      wait_thread.join();
+    }
+
+    // Unsetting the functions removes every watch and timeout
+    DBusConnection *conn = dbus->dbus_conn;
+    ::dbus_connection_set_dispatch_status_function(conn, nullptr, nullptr,
+                                                   nullptr);
+    ::dbus_connection_set_watch_functions(conn, nullptr, nullptr, nullptr,
+                                          nullptr, nullptr);
+    ::dbus_connection_set_timeout_functions(conn, nullptr, nullptr, nullptr,
+                                            nullptr, nullptr);
+    dbus->event_loop_attached = false;
+  }
+
+  watches.clear();
+  timeouts.clear();
+  ready.clear();
+  if (epoll_fd >= 0) {
+    ::close(epoll_fd);
+    epoll_fd = -1;
+  }
+  if (wake_fd >= 0) {
+    ::close(wake_fd);
+    wake_fd = -1;
+  }
+}
+
+// Returns true if the loop is running
+bool DBusEventLoop::is_running() { return running; }
+
+// Sleeps until a watched fd is ready or the next deadline passes, then wakes
+// the main thread. Runs on its own thread and never calls into libdbus.
+void DBusEventLoop::wait_thread_loop() {
+  struct epoll_event events[MAX_EVENTS];
+  while (running) {
+    int timeout_ms = -1;
+    uint64_t deadline = next_deadline_usec;
+    if (deadline != 0) {
+      uint64_t now = now_usec();
+      timeout_ms = now >= deadline ? 0 : (int)((deadline - now + 999) / 1000);
+    }
+
+    int count = ::epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    bool wake = false;
+    for (int i = 0; i < count; i++) {
+      if (events[i].data.fd == wake_fd) {
+        uint64_t value;
+        while (::read(wake_fd, &value, sizeof(value)) > 0) {
+        }
+        continue;
+      }
+      // Watched fds are one-shot and stay disabled until the main thread
+      // has handled them and armed them again
+      std::lock_guard<std::mutex> lock(ready_mutex);
+      ready.push_back(events[i]);
+      wake = true;
+    }
+
+    // Only wake once per deadline. The main thread sets the next one.
+    if (deadline != 0 && now_usec() >= deadline &&
+        next_deadline_usec.compare_exchange_strong(deadline, 0)) {
+      wake = true;
+    }
+
+    if (wake) {
+      schedule_wake();
+    }
+  }
+}
+
+// Asks the main thread to handle events, unless it was already asked
+void DBusEventLoop::schedule_wake() {
+  if (wake_scheduled.exchange(true)) {
+    return;
+  }
+  call_deferred("_on_wake");
+}
+
+// Wakes the wait thread so that it picks up a new deadline or stops
+void DBusEventLoop::notify_wait_thread() {
+  if (wake_fd < 0) {
+    return;
+  }
+  // EAGAIN means the counter is full, so a wakeup is already pending
+  uint64_t value = 1;
+  while (::write(wake_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+  }
+}
+
+// Registers the given fd with epoll for the union of the enabled watches on
+// it, or removes it if none are enabled. libdbus may use separate watches for
+// reading and writing the same fd.
+void DBusEventLoop::arm_fd(int fd) {
+  uint32_t events = 0;
+  for (DBusWatch *watch : watches) {
+    if (::dbus_watch_get_unix_fd(watch) == fd &&
+        ::dbus_watch_get_enabled(watch)) {
+      events |= watch_flags_to_events(::dbus_watch_get_flags(watch));
+    }
+  }
+
+  if (events == 0) {
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    return;
+  }
+  struct epoll_event event = {};
+  event.events = events | EPOLLONESHOT;
+  event.data.fd = fd;
+  if (::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0 &&
+      errno == ENOENT) {
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+  }
+}
+
+// Publishes the earliest deadline of any enabled timeout or pending call to
+// the wait thread
+void DBusEventLoop::update_deadline() {
+  uint64_t next = dbus->get_next_deadline_usec();
+  for (const DBusEventLoopTimeout &entry : timeouts) {
+    if (!::dbus_timeout_get_enabled(entry.timeout)) {
+      continue;
+    }
+    if (next == 0 || entry.deadline_usec < next) {
+      next = entry.deadline_usec;
+    }
+  }
+  next_deadline_usec = next;
+  notify_wait_thread();
+}
+
+// Handles everything the wait thread reported: does the pending I/O, runs
+// expired timeouts and dispatches the received messages
+void DBusEventLoop::_on_wake() {
+  wake_scheduled = false;
+  if (!running) {
+    return;
+  }
+
+  std::vector<struct epoll_event> events;
+  {
+    std::lock_guard<std::mutex> lock(ready_mutex);
+    events.swap(ready);
+  }
+
+  for (const struct epoll_event &event : events) {
+    int fd = event.data.fd;
+    unsigned int flags = events_to_watch_flags(event.events);
+
+    // Handling a watch may add or remove watches, so work on a copy and skip
+    // any that are gone by the time they are reached
+    std::vector<DBusWatch *> fd_watches;
+    for (DBusWatch *watch : watches) {
+      if (::dbus_watch_get_unix_fd(watch) == fd) {
+        fd_watches.push_back(watch);
+      }
+    }
+    for (DBusWatch *watch : fd_watches) {
+      if (std::find(watches.begin(), watches.end(), watch) == watches.end() ||
+          !::dbus_watch_get_enabled(watch)) {
+        continue;
+      }
+      unsigned int watch_flags = ::dbus_watch_get_flags(watch) |
+                                 DBUS_WATCH_ERROR | DBUS_WATCH_HANGUP;
+      unsigned int handle_flags = flags & watch_flags;
+      if (handle_flags != 0) {
+        ::dbus_watch_handle(watch, handle_flags);
+      }
+    }
+    arm_fd(fd);
+  }
+
+  // Run expired timeouts, rescheduling them for their next interval
+  uint64_t now = now_usec();
+  std::vector<DBusTimeout *> expired;
+  for (DBusEventLoopTimeout &entry : timeouts) {
+    if (::dbus_timeout_get_enabled(entry.timeout) &&
+        now >= entry.deadline_usec) {
+      entry.deadline_usec =
+          now + (uint64_t)::dbus_timeout_get_interval(entry.timeout) * 1000;
+      expired.push_back(entry.timeout);
+    }
+  }
+  for (DBusTimeout *timeout : expired) {
+    bool exists = false;
+    for (const DBusEventLoopTimeout &entry : timeouts) {
+      exists = exists || entry.timeout == timeout;
+    }
+    if (exists) {
+      ::dbus_timeout_handle(timeout);
+    }
+  }
+
+  dbus->dispatch(max_dispatch);
+  if (::dbus_connection_get_dispatch_status(dbus->dbus_conn) ==
+      DBUS_DISPATCH_DATA_REMAINS) {
+    schedule_wake();
+  }
+  update_deadline();
+}
+
+// Called by libdbus when it needs a new fd watched
+dbus_bool_t DBusEventLoop::add_watch(DBusWatch *watch, void *user_data) {
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  loop->watches.push_back(watch);
+  loop->arm_fd(::dbus_watch_get_unix_fd(watch));
+  return true;
+}
+
+// Called by libdbus when an fd no longer needs to be watched
+void DBusEventLoop::remove_watch(DBusWatch *watch, void *user_data) {
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  loop->watches.erase(
+      std::remove(loop->watches.begin(), loop->watches.end(), watch),
+      loop->watches.end());
+  loop->arm_fd(::dbus_watch_get_unix_fd(watch));
+}
+
+// Called by libdbus when a watch is enabled or disabled, e.g. when there is
+// outgoing data to write
+void DBusEventLoop::toggle_watch(DBusWatch *watch, void *user_data) {
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  loop->arm_fd(::dbus_watch_get_unix_fd(watch));
+}
+
+// Called by libdbus when it needs a timer, e.g. for a method call timeout
+dbus_bool_t DBusEventLoop::add_timeout(DBusTimeout *timeout, void *user_data) {
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  DBusEventLoopTimeout entry;
+  entry.timeout = timeout;
+  entry.deadline_usec =
+      now_usec() + (uint64_t)::dbus_timeout_get_interval(timeout) * 1000;
+  loop->timeouts.push_back(entry);
+  loop->update_deadline();
+  return true;
+}
+
+// Called by libdbus when a timer is no longer needed
+void DBusEventLoop::remove_timeout(DBusTimeout *timeout, void *user_data) {
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  for (size_t i = 0; i < loop->timeouts.size(); i++) {
+    if (loop->timeouts[i].timeout == timeout) {
+      loop->timeouts.erase(loop->timeouts.begin() + i);
+      break;
+    }
+  }
+  loop->update_deadline();
+}
+
+// Called by libdbus when a timer is enabled or disabled. Enabling a timer
+// starts its interval over.
+void DBusEventLoop::toggle_timeout(DBusTimeout *timeout, void *user_data) {
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  for (DBusEventLoopTimeout &entry : loop->timeouts) {
+    if (entry.timeout == timeout) {
+      entry.deadline_usec =
+          now_usec() + (uint64_t)::dbus_timeout_get_interval(timeout) * 1000;
+    }
+  }
+  loop->update_deadline();
+}
+
+// Called by libdbus when messages are queued and waiting to be dispatched
+void DBusEventLoop::dispatch_status_changed(DBusConnection *conn,
+                                            DBusDispatchStatus status,
+                                            void *user_data) {
+  if (status != DBUS_DISPATCH_DATA_REMAINS) {
+    return;
+  }
+  DBusEventLoop *loop = (DBusEventLoop *)user_data;
+  loop->schedule_wake();
+}
+
+// Register the methods with Godot
+void DBusEventLoop::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("stop"), &DBusEventLoop::stop);
+  ClassDB::bind_method(D_METHOD("is_running"), &DBusEventLoop::is_running);
+  ClassDB::bind_method(D_METHOD("_on_wake"), &DBusEventLoop::_on_wake);
+};
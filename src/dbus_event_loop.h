@@ -0,0 +1,85 @@
+#ifndef DBUS_EVENT_LOOP_CLASS_H
+#define DBUS_EVENT_LOOP_CLASS_H
+
+#include <atomic>
+#include <cstdint>
+#include <dbus/dbus.h>
+#include <mutex>
+#include <sys/epoll.h>
+#include <thread>
+#include <vector>
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+class DBus;
+
+// A libdbus timeout along with when it next expires
+struct DBusEventLoopTimeout {
+  DBusTimeout *timeout = nullptr;
+  uint64_t deadline_usec = 0;
+};
+
+// Event driven pumping of a connection. libdbus reports the sockets and
+// timers it needs through its watch and timeout functions, and a thread
+// sleeps in epoll_wait on them. Only when one of them fires is the main
+// thread woken, with a deferred call, to do the I/O and dispatch messages,
+// so an idle connection costs nothing per frame. All libdbus calls are still
+// made on the main thread.
+class DBusEventLoop : public godot::RefCounted {
+  GDCLASS(DBusEventLoop, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  // Main thread state
+  std::vector<DBusWatch *> watches;
+  std::vector<DBusEventLoopTimeout> timeouts;
+
+  // Shared with the wait thread
+  std::thread wait_thread;
+  std::atomic<bool> running{false};
+  std::atomic<bool> wake_scheduled{false};
+  std::atomic<uint64_t> next_deadline_usec{0};
+  std::mutex ready_mutex;
+  std::vector<struct epoll_event> ready;
+  int epoll_fd = -1;
+  int wake_fd = -1;
+
+  void wait_thread_loop();
+  void schedule_wake();
+  void notify_wait_thread();
+  void arm_fd(int fd);
+  void update_deadline();
+  static dbus_bool_t add_watch(DBusWatch *watch, void *user_data);
+  static void remove_watch(DBusWatch *watch, void *user_data);
+  static void toggle_watch(DBusWatch *watch, void *user_data);
+  static dbus_bool_t add_timeout(DBusTimeout *timeout, void *user_data);
+  static void remove_timeout(DBusTimeout *timeout, void *user_data);
+  static void toggle_timeout(DBusTimeout *timeout, void *user_data);
+  static void dispatch_status_changed(DBusConnection *conn,
+                                      DBusDispatchStatus status,
+                                      void *user_data);
+
+public:
+  // Constructor/deconstructor
+  DBusEventLoop();
+  ~DBusEventLoop();
+
+  // Properties
+  godot::Ref<DBus> dbus;
+  int max_dispatch = 1024;
+
+  // Methods
+  int start();
+  void stop();
+  bool is_running();
+  void _on_wake();
+};
+
+#endif // DBUS_EVENT_LOOP_CLASS_H
@@ -0,0 +1,136 @@
+#include "dbus_introspection.h"
+
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/classes/xml_parser.hpp"
+#include "godot_cpp/variant/utility_functions.hpp"
+
+using godot::PackedByteArray;
+using godot::Ref;
+using godot::String;
+using godot::XMLParser;
+
+// Parses introspection XML. Returns nullptr if the document is malformed.
+std::shared_ptr<const DBusIntrospection>
+DBusIntrospection::parse(const PackedByteArray &xml) {
+  Ref<XMLParser> parser;
+  parser.instantiate();
+  if (parser->open_buffer(xml) != godot::OK) {
+    return nullptr;
+  }
+
+  std::shared_ptr<DBusIntrospection> result =
+      std::make_shared<DBusIntrospection>();
+  DBusIntrospectedInterface *iface = nullptr;
+  DBusIntrospectedMethod *method = nullptr;
+  int depth = 0;
+  // Depth of a child node being skipped, or zero
+  int child_depth = 0;
+
+  godot::Error err;
+  while ((err = parser->read()) == godot::OK) {
+    XMLParser::NodeType type = parser->get_node_type();
+    if (type == XMLParser::NODE_ELEMENT_END) {
+      depth--;
+      if (child_depth > 0) {
+        if (depth < child_depth) {
+          child_depth = 0;
+        }
+        continue;
+      }
+      String element = parser->get_node_name();
+      if (element == "interface") {
+        iface = nullptr;
+      } else if (element == "method") {
+        method = nullptr;
+      }
+      continue;
+    }
+    if (type != XMLParser::NODE_ELEMENT) {
+      continue;
+    }
+
+    String element = parser->get_node_name();
+    String name = parser->get_named_attribute_value_safe("name");
+    bool empty = parser->is_empty();
+    if (!empty) {
+      depth++;
+    }
+    if (child_depth > 0) {
+      continue;
+    }
+
+    // Child objects are listed as nested nodes with a relative name. Anything
+    // a child node contains describes the child, not this object.
+    if (element == "node") {
+      if (depth > 1 || (empty && depth > 0)) {
+        result->nodes.append(name);
+        if (!empty) {
+          child_depth = depth;
+        }
+      }
+      continue;
+    }
+
+    if (element == "interface") {
+      result->interfaces.push_back(DBusIntrospectedInterface());
+      iface = &result->interfaces.ptrw()[result->interfaces.size() - 1];
+      iface->name = name;
+      if (empty) {
+        iface = nullptr;
+      }
+      continue;
+    }
+    if (iface == nullptr) {
+      continue;
+    }
+
+    if (element == "method") {
+      iface->methods.insert(name, DBusIntrospectedMethod());
+      method = iface->methods.getptr(name);
+      if (empty) {
+        method = nullptr;
+      }
+    } else if (element == "arg" && method != nullptr) {
+      // Method arguments are inputs unless marked otherwise
+      String type_sig = parser->get_named_attribute_value_safe("type");
+      if (parser->get_named_attribute_value_safe("direction") == "out") {
+        method->out_signature += type_sig;
+      } else {
+        method->in_signature += type_sig;
+      }
+    } else if (element == "property") {
+      DBusIntrospectedProperty property;
+      property.signature = parser->get_named_attribute_value_safe("type");
+      property.access = parser->get_named_attribute_value_safe("access");
+      property.plan = DBusSignaturePlan::get(property.signature);
+      iface->properties.insert(name, property);
+    } else if (element == "signal") {
+      iface->signals.append(name);
+    }
+  }
+  if (err != godot::ERR_FILE_EOF) {
+    return nullptr;
+  }
+
+  // Compile the input signatures now that all arguments are known
+  for (int i = 0; i < result->interfaces.size(); i++) {
+    for (godot::KeyValue<String, DBusIntrospectedMethod> &entry :
+         result->interfaces.ptrw()[i].methods) {
+      entry.value.in_plan = DBusSignaturePlan::get(entry.value.in_signature);
+    }
+  }
+
+  return result;
+}
+
+// Returns the interface with the given name, or nullptr if the object does
+// not implement it
+const DBusIntrospectedInterface *
+DBusIntrospection::find_interface(const String &name) const {
+  for (int i = 0; i < interfaces.size(); i++) {
+    if (interfaces[i].name == name) {
+      return &interfaces[i];
+    }
+  }
+  return nullptr;
+}
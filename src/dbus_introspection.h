@@ -0,0 +1,50 @@
+#ifndef DBUS_INTROSPECTION_H
+#define DBUS_INTROSPECTION_H
+
+#include <memory>
+
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/templates/vector.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+#include "godot_cpp/variant/string.hpp"
+
+#include "dbus_signature_plan.h"
+
+// A method of an introspected interface. The signature of its input arguments
+// is compiled once so calls through a proxy skip validating it.
+struct DBusIntrospectedMethod {
+  godot::String in_signature;
+  godot::String out_signature;
+  std::shared_ptr<const DBusSignaturePlan> in_plan;
+};
+
+// A property of an introspected interface with its compiled type
+struct DBusIntrospectedProperty {
+  godot::String signature;
+  godot::String access;
+  std::shared_ptr<const DBusSignaturePlan> plan;
+};
+
+// An introspected interface
+struct DBusIntrospectedInterface {
+  godot::String name;
+  godot::HashMap<godot::String, DBusIntrospectedMethod> methods;
+  godot::HashMap<godot::String, DBusIntrospectedProperty> properties;
+  godot::PackedStringArray signals;
+};
+
+// The parsed introspection data of a single object, as returned by the
+// org.freedesktop.DBus.Introspectable.Introspect method. Immutable once
+// parsed, so it can be shared by every proxy of the object.
+struct DBusIntrospection {
+  godot::Vector<DBusIntrospectedInterface> interfaces;
+  godot::PackedStringArray nodes;
+
+  static std::shared_ptr<const DBusIntrospection>
+  parse(const godot::PackedByteArray &xml);
+  const DBusIntrospectedInterface *
+  find_interface(const godot::String &name) const;
+};
+
+#endif // DBUS_INTROSPECTION_H
@@ -1,5 +1,10 @@
 #include "dbus_message.h"
 #include "dbus/dbus-protocol.h"
+#include "dbus_unix_fd.h"
+#include "godot_cpp/classes/time.hpp"
+#include "godot_cpp/variant/packed_float64_array.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/packed_int64_array.hpp"
 
 using godot::Array;
 using godot::ClassDB;
@@ -7,6 +12,7 @@ using godot::D_METHOD;
 using godot::Dictionary;
 using godot::PackedStringArray;
 using godot::String;
+using godot::StringName;
 using godot::Variant;
 
 DBusMessage::DBusMessage(){};
@@ -17,15 +23,50 @@ DBusMessage::~DBusMessage() {
   ::dbus_message_unref(message);
 };
 
+// Replaces the wrapped message, releasing the previous one. Used to reuse
+// wrappers from the message pool.
+void DBusMessage::reset(::DBusMessage *msg) {
+  if (message != nullptr) {
+    ::dbus_message_unref(message);
+  }
+  message = msg;
+  stats.reset();
+  headers_cached = false;
+  path_name = godot::StringName();
+  sender_name = godot::StringName();
+  member_name = godot::StringName();
+  iface_name = godot::StringName();
+}
+
 bool DBusMessage::is_empty() { return (message == nullptr); }
 
-// Returns true if the message matches the given interface and name
-bool DBusMessage::is_signal(String iface, String name) {
+// Interns the header fields of the message
+void DBusMessage::cache_headers() {
+  headers_cached = true;
   if (is_empty()) {
+    return;
+  }
+  const char *path = ::dbus_message_get_path(message);
+  const char *sender = ::dbus_message_get_sender(message);
+  const char *member = ::dbus_message_get_member(message);
+  const char *iface = ::dbus_message_get_interface(message);
+  path_name = path != nullptr ? StringName(path) : StringName();
+  sender_name = sender != nullptr ? StringName(sender) : StringName();
+  member_name = member != nullptr ? StringName(member) : StringName();
+  iface_name = iface != nullptr ? StringName(iface) : StringName();
+}
+
+// Returns true if the message is a signal with the given interface and name.
+// Both names are interned, so this compares pointers.
+bool DBusMessage::is_signal(const StringName &iface, const StringName &name) {
+  if (is_empty() ||
+      ::dbus_message_get_type(message) != DBUS_MESSAGE_TYPE_SIGNAL) {
     return false;
   }
-  return ::dbus_message_is_signal(message, iface.ascii().get_data(),
-                                  name.ascii().get_data());
+  if (!headers_cached) {
+    cache_headers();
+  }
+  return member_name == name && iface_name == iface;
 }
 
 // Gets the type of a message.
@@ -42,33 +83,47 @@ int DBusMessage::get_type() {
 };
 
 // Return the path to the object this message is for or from
-String DBusMessage::get_path() {
-  if (is_empty()) {
-    return String();
-  }
-
-  const char *path = ::dbus_message_get_path(message);
-  return String(path);
-}
+String DBusMessage::get_path() { return get_path_name(); }
 
 // Return the sender of this message
-String DBusMessage::get_sender() {
-  if (is_empty()) {
-    return String();
+String DBusMessage::get_sender() { return get_sender_name(); }
+
+// Return the member of this message
+String DBusMessage::get_member() { return get_member_name(); }
+
+// Return the interface of this message
+String DBusMessage::get_interface() { return get_interface_name(); }
+
+// Return the interned path of this message
+StringName DBusMessage::get_path_name() {
+  if (!headers_cached) {
+    cache_headers();
   }
+  return path_name;
+}
 
-  const char *sender = ::dbus_message_get_sender(message);
-  return String(sender);
+// Return the interned sender of this message
+StringName DBusMessage::get_sender_name() {
+  if (!headers_cached) {
+    cache_headers();
+  }
+  return sender_name;
 }
 
-// Return the member of this message
-String DBusMessage::get_member() {
-  if (is_empty()) {
-    return String();
+// Return the interned member of this message
+StringName DBusMessage::get_member_name() {
+  if (!headers_cached) {
+    cache_headers();
   }
+  return member_name;
+}
 
-  const char *membr = ::dbus_message_get_member(message);
-  return String(membr);
+// Return the interned interface of this message
+StringName DBusMessage::get_interface_name() {
+  if (!headers_cached) {
+    cache_headers();
+  }
+  return iface_name;
 }
 
 // Gets the type signature of the message, i.e. the arguments in the message
@@ -94,15 +149,29 @@ String DBusMessage::get_error_name() {
   return String(err);
 }
 
+// Returns the string for the given value, converting it only the first time
+// it is seen
+const String &DBusDecodeArena::intern(const char *value) {
+  std::string_view key(value);
+  String *found = strings.getptr(key);
+  if (found != nullptr) {
+    return *found;
+  }
+  return strings.insert(key, String::utf8(value, key.size()))->value;
+}
+
 // Convert a DBus string into a godot string
-String get_arg_string(DBusMessageIter *iter) {
+String get_arg_string(DBusMessageIter *iter, DBusDecodeArena *arena) {
   const char *value;
   ::dbus_message_iter_get_basic(iter, &value);
-  return String(value);
+  if (arena != nullptr) {
+    return arena->intern(value);
+  }
+  return String::utf8(value);
 }
 
 // Convert a DBus variant into a I dunno wtf
-Variant get_arg_variant(DBusMessageIter *iter) {
+Variant get_arg_variant(DBusMessageIter *iter, DBusDecodeArena *arena) {
   // const char *signature = ::dbus_message_iter_get_signature(iter);
   // godot::UtilityFunctions::print("Found variant signature: ", signature);
 
@@ -110,14 +179,14 @@ Variant get_arg_variant(DBusMessageIter *iter) {
   DBusMessageIter sub_iter;
   ::dbus_message_iter_recurse(iter, &sub_iter);
 
-  Variant value = get_arg(&sub_iter);
+  Variant value = get_arg(&sub_iter, arena);
 
   return value;
 }
 
 // Convert a DBus dictionary into a godot dictionary. For DBus, a dictionary
 // is actually an array of dictionary entries.
-Dictionary get_arg_dictionary(DBusMessageIter *iter) {
+Dictionary get_arg_dictionary(DBusMessageIter *iter, DBusDecodeArena *arena) {
   Dictionary dict = Dictionary();
 
   // A DBus Dictionary is actually an Array of DictionaryEntry objects.
@@ -125,36 +194,14 @@ Dictionary get_arg_dictionary(DBusMessageIter *iter) {
   DBusMessageIter sub_iter;
   ::dbus_message_iter_recurse(iter, &sub_iter);
 
-  // Loop through each DictionaryEntry in the array.
-  int arg_type;
-  while ((arg_type = ::dbus_message_iter_get_arg_type(&sub_iter)) !=
-         DBUS_TYPE_INVALID) {
-
-    // Recurse into the dictionary entry
+  // Loop through each DictionaryEntry in the array. Every entry holds exactly
+  // one key followed by one value.
+  while (::dbus_message_iter_get_arg_type(&sub_iter) != DBUS_TYPE_INVALID) {
     DBusMessageIter entry_iter;
     ::dbus_message_iter_recurse(&sub_iter, &entry_iter);
-
-    // Loop through each DictionaryEntry object. This will alternate between key
-    // and value
-    int i = 0;
-    Variant key;
-    int entry_type;
-    while ((entry_type = ::dbus_message_iter_get_arg_type(&entry_iter)) !=
-           DBUS_TYPE_INVALID) {
-
-      // Convert the key or value to a Godot type
-      Variant item = get_arg(&entry_iter);
-
-      // If it's even, it's a key, odd is a value
-      if (i % 2 == 0) {
-        key = item;
-      } else {
-        dict[key] = item;
-      }
-
-      ::dbus_message_iter_next(&entry_iter);
-      i++;
-    }
+    Variant key = get_arg(&entry_iter, arena);
+    ::dbus_message_iter_next(&entry_iter);
+    dict[key] = get_arg(&entry_iter, arena);
 
     ::dbus_message_iter_next(&sub_iter);
   }
@@ -162,15 +209,14 @@ Dictionary get_arg_dictionary(DBusMessageIter *iter) {
   return dict;
 }
 
-// Convert a DBus array into a godot array
-Array get_arg_array(DBusMessageIter *iter) {
+// Convert a DBus array into a godot array. The array is sized up front from
+// the element count so it is allocated once.
+Array get_arg_array(DBusMessageIter *iter, DBusDecodeArena *arena) {
   Array arr = Array();
 
-  // Get the number of elements and type of the array
+  // Get the number of elements of the array
   int element_count = ::dbus_message_iter_get_element_count(iter);
-  int array_type = ::dbus_message_iter_get_element_type(iter);
-  char array_char = (char)array_type;
-  // godot::UtilityFunctions::print("Found array type: ", String(&array_char));
+  arr.resize(element_count);
 
   // Iterate through the container with a sub-iterator
   DBusMessageIter sub_iter;
@@ -178,16 +224,144 @@ Array get_arg_array(DBusMessageIter *iter) {
 
   // Loop through each item and add it to the array
   for (int i = 0; i < element_count; i++) {
-    Variant value = get_arg(&sub_iter);
-    arr.append(value);
+    arr[i] = get_arg(&sub_iter, arena);
+    ::dbus_message_iter_next(&sub_iter);
+  }
+
+  return arr;
+}
+
+// Convert a DBus struct into a godot array with one element per field
+Array get_arg_struct(DBusMessageIter *iter, DBusDecodeArena *arena) {
+  Array fields = Array();
+
+  DBusMessageIter sub_iter;
+  ::dbus_message_iter_recurse(iter, &sub_iter);
+  while (::dbus_message_iter_get_arg_type(&sub_iter) != DBUS_TYPE_INVALID) {
+    fields.append(get_arg(&sub_iter, arena));
+    ::dbus_message_iter_next(&sub_iter);
+  }
+
+  return fields;
+}
+
+// Convert a DBus unix fd into an owned fd wrapper. libdbus hands out a
+// duplicate of the descriptor that the caller has to close.
+Variant get_arg_unix_fd(DBusMessageIter *iter) {
+  int fd = -1;
+  ::dbus_message_iter_get_basic(iter, &fd);
+  if (fd < 0) {
+    return Variant();
+  }
+  DBusUnixFd *unix_fd = memnew(DBusUnixFd);
+  unix_fd->set_fd(fd);
+  return Variant(unix_fd);
+}
+
+// Copies a fixed size DBus array into the given packed array
+template <typename T, typename P>
+P get_arg_fixed_array(DBusMessageIter *iter) {
+  DBusMessageIter sub_iter;
+  ::dbus_message_iter_recurse(iter, &sub_iter);
+
+  const T *data = nullptr;
+  int count = 0;
+  ::dbus_message_iter_get_fixed_array(&sub_iter, &data, &count);
+
+  P arr = P();
+  arr.resize(count);
+  if (count > 0) {
+    memcpy(arr.ptrw(), data, count * sizeof(T));
+  }
+  return arr;
+}
+
+// Copies a fixed size DBus array into a packed array with wider elements
+template <typename T, typename P>
+P get_arg_fixed_array_widened(DBusMessageIter *iter) {
+  DBusMessageIter sub_iter;
+  ::dbus_message_iter_recurse(iter, &sub_iter);
+
+  const T *data = nullptr;
+  int count = 0;
+  ::dbus_message_iter_get_fixed_array(&sub_iter, &data, &count);
+
+  P arr = P();
+  arr.resize(count);
+  auto *dest = arr.ptrw();
+  for (int i = 0; i < count; i++) {
+    dest[i] = data[i];
+  }
+  return arr;
+}
+
+// Convert a DBus array of strings, object paths or signatures into a godot
+// packed string array
+PackedStringArray get_arg_string_array(DBusMessageIter *iter,
+                                       DBusDecodeArena *arena) {
+  PackedStringArray arr = PackedStringArray();
+  int element_count = ::dbus_message_iter_get_element_count(iter);
+  arr.resize(element_count);
+  String *dest = arr.ptrw();
+
+  DBusMessageIter sub_iter;
+  ::dbus_message_iter_recurse(iter, &sub_iter);
+  for (int i = 0; i < element_count; i++) {
+    const char *value;
+    ::dbus_message_iter_get_basic(&sub_iter, &value);
+    dest[i] = arena != nullptr ? arena->intern(value) : String::utf8(value);
     ::dbus_message_iter_next(&sub_iter);
   }
 
   return arr;
 }
 
-// Converts the given DBus argument to a Godot variant
-Variant get_arg(DBusMessageIter *iter) {
+// Convert a homogeneous DBus array into the matching godot packed array.
+// Returns false if the array type has no packed equivalent.
+bool get_arg_packed_array(DBusMessageIter *iter, int array_type,
+                          Variant *r_value, DBusDecodeArena *arena) {
+  switch (array_type) {
+  case DBUS_TYPE_BYTE:
+    *r_value = get_arg_fixed_array<uint8_t, godot::PackedByteArray>(iter);
+    return true;
+  case DBUS_TYPE_INT16:
+    *r_value =
+        get_arg_fixed_array_widened<int16_t, godot::PackedInt32Array>(iter);
+    return true;
+  case DBUS_TYPE_UINT16:
+    *r_value =
+        get_arg_fixed_array_widened<uint16_t, godot::PackedInt32Array>(iter);
+    return true;
+  case DBUS_TYPE_INT32:
+    *r_value = get_arg_fixed_array<int32_t, godot::PackedInt32Array>(iter);
+    return true;
+  case DBUS_TYPE_UINT32:
+    // Widened so that values above INT32_MAX are not wrapped
+    *r_value =
+        get_arg_fixed_array_widened<uint32_t, godot::PackedInt64Array>(iter);
+    return true;
+  case DBUS_TYPE_INT64:
+    *r_value = get_arg_fixed_array<int64_t, godot::PackedInt64Array>(iter);
+    return true;
+  case DBUS_TYPE_UINT64:
+    *r_value = get_arg_fixed_array<uint64_t, godot::PackedInt64Array>(iter);
+    return true;
+  case DBUS_TYPE_DOUBLE:
+    *r_value = get_arg_fixed_array<double, godot::PackedFloat64Array>(iter);
+    return true;
+  case DBUS_TYPE_STRING:
+  case DBUS_TYPE_OBJECT_PATH:
+  case DBUS_TYPE_SIGNATURE:
+    *r_value = get_arg_string_array(iter, arena);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Converts the given DBus argument to a Godot variant. Passing an arena shares
+// repeated strings between all values decoded with it.
+Variant get_arg(DBusMessageIter *iter, DBusDecodeArena *arena) {
   int arg_type = ::dbus_message_iter_get_arg_type(iter);
   char type[2];
   type[0] = (char)arg_type;
@@ -202,12 +376,18 @@ Variant get_arg(DBusMessageIter *iter) {
     if (array_type == DBUS_TYPE_DICT_ENTRY) {
       // This is a dictionary!
       // godot::UtilityFunctions::print("Found dict type!");
-      Dictionary dict = get_arg_dictionary(iter);
+      Dictionary dict = get_arg_dictionary(iter, arena);
       return Variant(dict);
     }
 
+    // Arrays of basic types are decoded straight into packed arrays
+    Variant packed;
+    if (get_arg_packed_array(iter, array_type, &packed, arena)) {
+      return packed;
+    }
+
     // godot::UtilityFunctions::print("Found array type!");
-    Array arr = get_arg_array(iter);
+    Array arr = get_arg_array(iter, arena);
     return Variant(arr);
   }
 
@@ -269,47 +449,198 @@ Variant get_arg(DBusMessageIter *iter) {
   if (arg_type == DBUS_TYPE_STRING || arg_type == DBUS_TYPE_OBJECT_PATH ||
       arg_type == DBUS_TYPE_SIGNATURE) {
     // godot::UtilityFunctions::print("Found string type!");
-    String value = get_arg_string(iter);
+    String value = get_arg_string(iter, arena);
     return Variant(value);
   }
   if (arg_type == DBUS_TYPE_VARIANT) {
     // godot::UtilityFunctions::print("Found variant type!");
-    Variant value = get_arg_variant(iter);
+    Variant value = get_arg_variant(iter, arena);
     return value;
   }
+  if (arg_type == DBUS_TYPE_STRUCT) {
+    Array value = get_arg_struct(iter, arena);
+    return Variant(value);
+  }
+  if (arg_type == DBUS_TYPE_UNIX_FD) {
+    return get_arg_unix_fd(iter);
+  }
 
-  // TODO: Implement struct, unix fd
   // godot::UtilityFunctions::push_warning("Unknown type!");
   return Variant();
 }
 
+// Returns the time decoding started at if decoding is timed, or zero
+uint64_t DBusMessage::begin_decode() {
+  if (stats == nullptr) {
+    return 0;
+  }
+  return godot::Time::get_singleton()->get_ticks_usec();
+}
+
+// Records the time spent decoding since "begin" in the connection's stats
+void DBusMessage::end_decode(uint64_t begin) {
+  if (stats == nullptr) {
+    return;
+  }
+  stats->decode_usec.add(godot::Time::get_singleton()->get_ticks_usec() -
+                         begin);
+}
+
 // Gets the arguments from the message
 Array DBusMessage::get_args() {
   Array args = Array();
   if (is_empty()) {
     return args;
   }
+  uint64_t begin = begin_decode();
 
   // Loop through each argument
   int arg_type;
+  DBusDecodeArena arena;
   DBusMessageIter iter;
   ::dbus_message_iter_init(message, &iter);
   while ((arg_type = ::dbus_message_iter_get_arg_type(&iter)) !=
          DBUS_TYPE_INVALID) {
-    Variant arg = get_arg(&iter);
+    Variant arg = ::get_arg(&iter, &arena);
     args.append(arg);
     dbus_message_iter_next(&iter);
   }
 
+  end_decode(begin);
   return args;
 }
 
+// Returns the number of arguments in the message without decoding them
+int DBusMessage::get_arg_count() {
+  if (is_empty()) {
+    return 0;
+  }
+
+  int count = 0;
+  DBusMessageIter iter;
+  ::dbus_message_iter_init(message, &iter);
+  while (::dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_INVALID) {
+    count++;
+    ::dbus_message_iter_next(&iter);
+  }
+
+  return count;
+}
+
+// Decodes and returns only the argument at the given index
+Variant DBusMessage::get_arg(int index) {
+  if (is_empty() || index < 0) {
+    return Variant();
+  }
+  uint64_t begin = begin_decode();
+
+  Variant value;
+  DBusMessageIter iter;
+  bool found = ::dbus_message_iter_init(message, &iter);
+  for (int i = 0; found && i < index; i++) {
+    found = ::dbus_message_iter_next(&iter);
+  }
+  if (found) {
+    DBusDecodeArena arena;
+    value = ::get_arg(&iter, &arena);
+  }
+
+  end_decode(begin);
+  return value;
+}
+
+// Moves the given iterator to the value stored under "key" in the container
+// it points at, looking through any variants on the way. Dictionary entries
+// are matched on their key, while arrays and structs are indexed by integer
+// keys. Returns false if there is no such value.
+bool find_arg_key(DBusMessageIter *iter, const Variant &key) {
+  // Look through variants to the value they contain
+  while (::dbus_message_iter_get_arg_type(iter) == DBUS_TYPE_VARIANT) {
+    DBusMessageIter sub_iter;
+    ::dbus_message_iter_recurse(iter, &sub_iter);
+    *iter = sub_iter;
+  }
+
+  int arg_type = ::dbus_message_iter_get_arg_type(iter);
+  if (arg_type != DBUS_TYPE_ARRAY && arg_type != DBUS_TYPE_STRUCT) {
+    return false;
+  }
+  bool is_dict = arg_type == DBUS_TYPE_ARRAY &&
+                 ::dbus_message_iter_get_element_type(iter) ==
+                     DBUS_TYPE_DICT_ENTRY;
+
+  DBusMessageIter sub_iter;
+  ::dbus_message_iter_recurse(iter, &sub_iter);
+
+  // Arrays and structs are indexed
+  if (!is_dict) {
+    if (key.get_type() != Variant::INT) {
+      return false;
+    }
+    int64_t index = key;
+    for (int64_t i = 0; i < index; i++) {
+      if (!::dbus_message_iter_next(&sub_iter)) {
+        return false;
+      }
+    }
+    if (index < 0 ||
+        ::dbus_message_iter_get_arg_type(&sub_iter) == DBUS_TYPE_INVALID) {
+      return false;
+    }
+    *iter = sub_iter;
+    return true;
+  }
+
+  // Only decode the keys of each entry until a match is found. Keys are
+  // always basic types, so decoding them is cheap.
+  while (::dbus_message_iter_get_arg_type(&sub_iter) != DBUS_TYPE_INVALID) {
+    DBusMessageIter entry_iter;
+    ::dbus_message_iter_recurse(&sub_iter, &entry_iter);
+    if (get_arg(&entry_iter) == key) {
+      ::dbus_message_iter_next(&entry_iter);
+      *iter = entry_iter;
+      return true;
+    }
+    ::dbus_message_iter_next(&sub_iter);
+  }
+
+  return false;
+}
+
+// Decodes and returns only the value found by following the given keys from
+// the first argument, e.g. for a GetManagedObjects reply:
+// get_value("/org/bluez/hci0/dev_X", "org.bluez.Device1", "RSSI")
+// Returns null if the value does not exist.
+Variant DBusMessage::get_value(const Variant **args, GDExtensionInt arg_count,
+                               GDExtensionCallError &error) {
+  error.error = GDEXTENSION_CALL_OK;
+  if (is_empty()) {
+    return Variant();
+  }
+  uint64_t begin = begin_decode();
+
+  Variant value;
+  DBusMessageIter iter;
+  bool found = ::dbus_message_iter_init(message, &iter);
+  for (GDExtensionInt i = 0; found && i < arg_count; i++) {
+    found = find_arg_key(&iter, *args[i]);
+  }
+  if (found) {
+    DBusDecodeArena arena;
+    value = ::get_arg(&iter, &arena);
+  }
+
+  end_decode(begin);
+  return value;
+}
+
 // Configure the message as a method call
 void DBusMessage::new_method_call(String bus_name, String path, String iface,
                                   String method) {
   message = ::dbus_message_new_method_call(
       bus_name.ascii().get_data(), path.ascii().get_data(),
       iface.ascii().get_data(), method.ascii().get_data());
+  headers_cached = false;
 };
 
 // Register the methods with Godot
@@ -321,8 +652,21 @@ void DBusMessage::_bind_methods() {
   ClassDB::bind_method(D_METHOD("get_path"), &DBusMessage::get_path);
   ClassDB::bind_method(D_METHOD("get_sender"), &DBusMessage::get_sender);
   ClassDB::bind_method(D_METHOD("get_member"), &DBusMessage::get_member);
+  ClassDB::bind_method(D_METHOD("get_interface"), &DBusMessage::get_interface);
+  ClassDB::bind_method(D_METHOD("get_path_name"), &DBusMessage::get_path_name);
+  ClassDB::bind_method(D_METHOD("get_sender_name"),
+                       &DBusMessage::get_sender_name);
+  ClassDB::bind_method(D_METHOD("get_member_name"),
+                       &DBusMessage::get_member_name);
+  ClassDB::bind_method(D_METHOD("get_interface_name"),
+                       &DBusMessage::get_interface_name);
   ClassDB::bind_method(D_METHOD("get_signature"), &DBusMessage::get_signature);
   ClassDB::bind_method(D_METHOD("get_args"), &DBusMessage::get_args);
+  ClassDB::bind_method(D_METHOD("get_arg_count"), &DBusMessage::get_arg_count);
+  ClassDB::bind_method(D_METHOD("get_arg", "index"), &DBusMessage::get_arg);
+  ClassDB::bind_vararg_method(godot::METHOD_FLAGS_DEFAULT, "get_value",
+                              &DBusMessage::get_value,
+                              godot::MethodInfo("get_value"));
   ClassDB::bind_method(D_METHOD("get_error_name"),
                        &DBusMessage::get_error_name);
   ClassDB::bind_method(
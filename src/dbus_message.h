@@ -7,18 +7,42 @@
 #include <cstring>
 #include <dbus/dbus.h>
 #include <iostream>
+#include <memory>
+#include <string_view>
 
 #include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/templates/hashfuncs.hpp"
 #include "godot_cpp/variant/dictionary.hpp"
 #include "godot_cpp/variant/packed_byte_array.hpp"
 #include "godot_cpp/variant/packed_string_array.hpp"
 #include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/string_name.hpp"
 #include "godot_cpp/variant/variant.hpp"
+#include "dbus_stats.h"
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/core/binder_common.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
+struct DBusStringViewHasher {
+  static uint32_t hash(const std::string_view &value) {
+    return godot::hash_murmur3_buffer(value.data(), value.size());
+  }
+};
+
+// Scratch state for decoding a single message. Strings that occur more than
+// once in a reply, such as interface and property names in a
+// GetManagedObjects reply, are converted once and then shared by every
+// container they appear in. The keys point into the message, which outlives
+// the arena.
+struct DBusDecodeArena {
+  godot::HashMap<std::string_view, godot::String, DBusStringViewHasher>
+      strings;
+
+  const godot::String &intern(const char *value);
+};
+
 class DBusMessage : public godot::RefCounted {
   GDCLASS(DBusMessage, godot::RefCounted);
 
@@ -26,28 +50,58 @@ protected:
   static void _bind_methods();
 
 private:
+  // Header fields interned on first access. They never change for a given
+  // message, so repeated lookups and comparisons are pointer operations.
+  godot::StringName path_name;
+  godot::StringName sender_name;
+  godot::StringName member_name;
+  godot::StringName iface_name;
+  bool headers_cached = false;
+
+  void cache_headers();
+  uint64_t begin_decode();
+  void end_decode(uint64_t begin);
+
 public:
   // Constructor/deconstructor
   DBusMessage();
   ~DBusMessage();
 
   // Properties
-  ::DBusMessage *message;
+  ::DBusMessage *message = nullptr;
+  // Stats of the connection that received the message, if enabled
+  std::shared_ptr<DBusStats> stats;
+  // Index of the wrapper in the message pool that owns it, or -1
+  int pool_index = -1;
 
   // Methods
+  void reset(::DBusMessage *msg);
   bool is_empty();
   int get_type();
-  bool is_signal(godot::String iface, godot::String name);
+  bool is_signal(const godot::StringName &iface,
+                 const godot::StringName &name);
   godot::String get_error_name();
   godot::String get_signature();
   void new_method_call(godot::String bus_name, godot::String path,
                        godot::String iface, godot::String method);
   godot::Array get_args();
+  int get_arg_count();
+  godot::Variant get_arg(int index);
+  godot::Variant get_value(const godot::Variant **args,
+                           GDExtensionInt arg_count,
+                           GDExtensionCallError &error);
   godot::String get_path();
   godot::String get_sender();
   godot::String get_member();
+  godot::String get_interface();
+  godot::StringName get_path_name();
+  godot::StringName get_sender_name();
+  godot::StringName get_member_name();
+  godot::StringName get_interface_name();
 };
 
-godot::Variant get_arg(DBusMessageIter *iter);
+godot::Variant get_arg(DBusMessageIter *iter,
+                       DBusDecodeArena *arena = nullptr);
+bool find_arg_key(DBusMessageIter *iter, const godot::Variant &key);
 
 #endif // DBUS_MESSAGE_CLASS_H
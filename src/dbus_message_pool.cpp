@@ -0,0 +1,126 @@
+#include "dbus_message_pool.h"
+
+using godot::Dictionary;
+using godot::Ref;
+
+// Sets the maximum number of pooled wrappers. Wrappers beyond the new
+// capacity are dropped from the pool, which frees them once scripts let go of
+// them. A capacity of zero disables pooling.
+void DBusMessagePool::set_capacity(int new_capacity) {
+  capacity = new_capacity < 0 ? 0 : new_capacity;
+  if (entries.size() <= capacity) {
+    return;
+  }
+  for (int i = capacity; i < entries.size(); i++) {
+    entries[i]->pool_index = -1;
+  }
+  entries.resize(capacity);
+
+  // Forget the indices of the dropped wrappers
+  for (int i = free_list.size() - 1; i >= 0; i--) {
+    if (free_list[i] >= capacity) {
+      free_list.remove_at(i);
+    }
+  }
+  std::deque<int> kept;
+  for (int index : in_use) {
+    if (index < capacity) {
+      kept.push_back(index);
+    }
+  }
+  in_use.swap(kept);
+}
+
+// Returns the maximum number of pooled wrappers
+int DBusMessagePool::get_capacity() { return capacity; }
+
+// Returns a wrapper owning the given message. A free wrapper from the pool is
+// reused if there is one, otherwise a new one is allocated and added to the
+// pool while it has room.
+DBusMessage *DBusMessagePool::acquire(::DBusMessage *msg) {
+  if (capacity == 0) {
+    DBusMessage *wrapper = memnew(DBusMessage());
+    wrapper->message = msg;
+    return wrapper;
+  }
+
+  if (free_list.is_empty()) {
+    reclaim();
+  }
+  if (!free_list.is_empty()) {
+    int index = free_list[free_list.size() - 1];
+    free_list.remove_at(free_list.size() - 1);
+    hits++;
+    const Ref<DBusMessage> &entry = entries[index];
+    entry->reset(msg);
+    in_use.push_back(index);
+    return entry.ptr();
+  }
+
+  misses++;
+  DBusMessage *wrapper = memnew(DBusMessage());
+  wrapper->message = msg;
+  if (entries.size() < capacity) {
+    wrapper->pool_index = entries.size();
+    entries.push_back(Ref<DBusMessage>(wrapper));
+    in_use.push_back(wrapper->pool_index);
+  }
+  return wrapper;
+}
+
+// Releases the message held by the given wrapper right away if nothing but
+// the pool and the caller reference it anymore, instead of keeping it until
+// the wrapper is reclaimed. Wrappers the pool does not own are left alone,
+// since the caller's reference may not be the only one besides a script's.
+void DBusMessagePool::release(const Ref<DBusMessage> &wrapper) {
+  if (wrapper->pool_index < 0 || wrapper->get_reference_count() != 2) {
+    return;
+  }
+  wrapper->reset(nullptr);
+}
+
+// Checks up to "max_count" of the oldest wrappers in use and moves the ones
+// scripts no longer reference to the free list, dropping their messages (and
+// any file descriptors in them) right away.
+void DBusMessagePool::reclaim(int max_count) {
+  int count = in_use.size();
+  for (int i = 0; i < count && i < max_count; i++) {
+    int index = in_use.front();
+    in_use.pop_front();
+    const Ref<DBusMessage> &entry = entries[index];
+    if (entry->get_reference_count() != 1) {
+      in_use.push_back(index);
+      continue;
+    }
+    entry->reset(nullptr);
+    free_list.push_back(index);
+  }
+}
+
+// Returns the pool counters
+Dictionary DBusMessagePool::get_stats() {
+  Dictionary stats = Dictionary();
+  uint64_t total = hits + misses;
+  stats["hits"] = hits;
+  stats["misses"] = misses;
+  stats["hit_rate"] = total == 0 ? 0.0 : (double)hits / (double)total;
+  stats["size"] = entries.size();
+  stats["capacity"] = capacity;
+  return stats;
+}
+
+// Resets the pool counters
+void DBusMessagePool::reset_stats() {
+  hits = 0;
+  misses = 0;
+}
+
+// Drops all pooled wrappers
+void DBusMessagePool::clear() {
+  for (int i = 0; i < entries.size(); i++) {
+    entries[i]->pool_index = -1;
+  }
+  entries.clear();
+  free_list.clear();
+  in_use.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef DBUS_MESSAGE_POOL_H
+#define DBUS_MESSAGE_POOL_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+#include <deque>
+
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/templates/vector.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+
+#include "dbus_message.h"
+
+// Pool of DBusMessage wrappers that are reused instead of allocating a new
+// Godot object for every received message. The pool keeps a reference to
+// every wrapper it owns. A wrapper whose only remaining reference is the
+// pool's own is no longer in use by scripts: it drops its message and goes on
+// a free list to be handed out again. Wrappers in use are checked a bounded
+// batch at a time, oldest first. Disabled (capacity of zero) by default.
+class DBusMessagePool {
+private:
+  // Number of wrappers in use checked per reclaim
+  static const int RECLAIM_BATCH = 16;
+
+  godot::Vector<godot::Ref<DBusMessage>> entries;
+  // Indices of wrappers that can be handed out
+  godot::Vector<int> free_list;
+  // Indices of wrappers handed out, oldest first
+  std::deque<int> in_use;
+  int capacity = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+
+public:
+  void set_capacity(int new_capacity);
+  int get_capacity();
+  DBusMessage *acquire(::DBusMessage *msg);
+  void release(const godot::Ref<DBusMessage> &wrapper);
+  void reclaim(int max_count = RECLAIM_BATCH);
+  godot::Dictionary get_stats();
+  void reset_stats();
+  void clear();
+};
+
+#endif // DBUS_MESSAGE_POOL_H
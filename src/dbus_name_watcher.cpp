@@ -0,0 +1,115 @@
+#include "dbus_name_watcher.h"
+#include "dbus.h"
+
+using godot::Array;
+using godot::Callable;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::String;
+using godot::Variant;
+
+DBusNameWatcher::DBusNameWatcher(){};
+DBusNameWatcher::~DBusNameWatcher() {
+  if (subscription_id < 0 || dbus.is_null()) {
+    return;
+  }
+  dbus->unsubscribe(subscription_id);
+};
+
+// Subscribes to owner changes of the name and resolves its current owner. The
+// subscription is made first so that no change can be missed in between.
+int DBusNameWatcher::start() {
+  if (dbus.is_null()) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CONNECTION_ERROR;
+  }
+
+  // Only changes of this name are sent to us
+  subscription_id = dbus->subscribe(
+      DBUS_SERVICE_DBUS, DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS,
+      "NameOwnerChanged", Callable(this, "_on_name_owner_changed"), name);
+  if (subscription_id < 0) {
+    return godot::ERR_CANT_CREATE;
+  }
+
+  return refresh();
+}
+
+// Resolves the current owner of the name again with GetNameOwner
+int DBusNameWatcher::refresh() {
+  Array args = Array();
+  args.append(name);
+  godot::Ref<DBusMessage> reply = dbus->send_with_reply_and_block(
+      DBUS_SERVICE_DBUS, DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS, "GetNameOwner",
+      args, "s");
+  if (reply.is_null()) {
+    return godot::ERR_CANT_CONNECT;
+  }
+
+  // The bus replies with an error if nobody owns the name
+  if (reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    if (reply->get_error_name() != DBUS_ERROR_NAME_HAS_NO_OWNER) {
+      godot::UtilityFunctions::push_warning("Unable to get owner of ", name,
+                                            ": ", reply->get_error_name());
+      return godot::ERR_QUERY_FAILED;
+    }
+    owner = String();
+    return godot::OK;
+  }
+
+  owner = reply->get_arg(0);
+  return godot::OK;
+}
+
+// Returns true if the name currently has an owner
+bool DBusNameWatcher::has_owner() { return !owner.is_empty(); }
+
+// Returns the unique name of the current owner, or an empty string if the
+// name has no owner
+String DBusNameWatcher::get_owner() { return owner; }
+
+String DBusNameWatcher::get_name() { return name; }
+
+// Applies a NameOwnerChanged signal. A name that moves straight from one
+// owner to another vanishes and appears again.
+void DBusNameWatcher::_on_name_owner_changed(DBusMessage *msg) {
+  const char *changed_name = nullptr;
+  const char *old_owner = nullptr;
+  const char *new_owner = nullptr;
+  if (!::dbus_message_get_args(msg->message, nullptr, DBUS_TYPE_STRING,
+                               &changed_name, DBUS_TYPE_STRING, &old_owner,
+                               DBUS_TYPE_STRING, &new_owner,
+                               DBUS_TYPE_INVALID)) {
+    return;
+  }
+  if (name != String::utf8(changed_name)) {
+    return;
+  }
+
+  String previous = owner;
+  owner = String::utf8(new_owner);
+  if (!previous.is_empty() && previous != owner) {
+    emit_signal("name_vanished", name, previous);
+  }
+  if (!owner.is_empty() && previous != owner) {
+    emit_signal("name_appeared", name, owner);
+  }
+}
+
+// Register the methods with Godot
+void DBusNameWatcher::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("refresh"), &DBusNameWatcher::refresh);
+  ClassDB::bind_method(D_METHOD("has_owner"), &DBusNameWatcher::has_owner);
+  ClassDB::bind_method(D_METHOD("get_owner"), &DBusNameWatcher::get_owner);
+  ClassDB::bind_method(D_METHOD("get_name"), &DBusNameWatcher::get_name);
+  ClassDB::bind_method(D_METHOD("_on_name_owner_changed", "msg"),
+                       &DBusNameWatcher::_on_name_owner_changed);
+
+  // Signals
+  ADD_SIGNAL(MethodInfo("name_appeared", PropertyInfo(Variant::STRING, "name"),
+                        PropertyInfo(Variant::STRING, "owner")));
+  ADD_SIGNAL(MethodInfo("name_vanished", PropertyInfo(Variant::STRING, "name"),
+                        PropertyInfo(Variant::STRING, "owner")));
+};
@@ -0,0 +1,47 @@
+#ifndef DBUS_NAME_WATCHER_CLASS_H
+#define DBUS_NAME_WATCHER_CLASS_H
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "dbus_message.h"
+
+class DBus;
+
+// Tracks the owner of a single bus name. The owner is resolved once with
+// GetNameOwner and then kept up to date from the NameOwnerChanged signal, so
+// checking whether a service is running does not touch the bus.
+class DBusNameWatcher : public godot::RefCounted {
+  GDCLASS(DBusNameWatcher, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::String owner;
+  int subscription_id = -1;
+
+public:
+  // Constructor/deconstructor
+  DBusNameWatcher();
+  ~DBusNameWatcher();
+
+  // Properties
+  godot::Ref<DBus> dbus;
+  godot::String name;
+
+  // Methods
+  int start();
+  int refresh();
+  bool has_owner();
+  godot::String get_owner();
+  godot::String get_name();
+  void _on_name_owner_changed(DBusMessage *msg);
+};
+
+#endif // DBUS_NAME_WATCHER_CLASS_H
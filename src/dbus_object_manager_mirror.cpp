@@ -0,0 +1,253 @@
+#include "dbus_object_manager_mirror.h"
+#include "dbus.h"
+
+using godot::Array;
+using godot::Callable;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Dictionary;
+using godot::MethodInfo;
+using godot::PackedStringArray;
+using godot::PropertyInfo;
+using godot::String;
+using godot::Variant;
+
+static const char *OBJECT_MANAGER_IFACE = "org.freedesktop.DBus.ObjectManager";
+static const char *PROPERTIES_IFACE = "org.freedesktop.DBus.Properties";
+
+DBusObjectManagerMirror::DBusObjectManagerMirror(){};
+DBusObjectManagerMirror::~DBusObjectManagerMirror() {
+  if (dbus.is_null()) {
+    return;
+  }
+  for (int i = 0; i < subscription_ids.size(); i++) {
+    dbus->unsubscribe(subscription_ids[i]);
+  }
+};
+
+// Subscribes to changes of the object tree and fetches the initial tree. The
+// subscriptions are made first so that no change can be missed in between.
+int DBusObjectManagerMirror::start() {
+  if (dbus.is_null()) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CONNECTION_ERROR;
+  }
+
+  int ids[3];
+  ids[0] = dbus->subscribe(bus_name, path, OBJECT_MANAGER_IFACE,
+                           "InterfacesAdded",
+                           Callable(this, "_on_interfaces_added"));
+  ids[1] = dbus->subscribe(bus_name, path, OBJECT_MANAGER_IFACE,
+                           "InterfacesRemoved",
+                           Callable(this, "_on_interfaces_removed"));
+  ids[2] = dbus->subscribe(bus_name, "", PROPERTIES_IFACE, "PropertiesChanged",
+                           Callable(this, "_on_properties_changed"));
+  for (int i = 0; i < 3; i++) {
+    if (ids[i] < 0) {
+      return godot::ERR_CANT_CREATE;
+    }
+    subscription_ids.push_back(ids[i]);
+  }
+
+  return refresh();
+}
+
+// Fetches the whole object tree again with a single GetManagedObjects call
+int DBusObjectManagerMirror::refresh() {
+  godot::Ref<DBusMessage> reply = dbus->send_with_reply_and_block(
+      bus_name, path, OBJECT_MANAGER_IFACE, "GetManagedObjects", Array(), "");
+  if (reply.is_null()) {
+    return godot::ERR_CANT_CONNECT;
+  }
+  if (reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    godot::UtilityFunctions::push_warning("Unable to get managed objects of ",
+                                          bus_name, " at ", path, ": ",
+                                          reply->get_error_name());
+    return godot::ERR_QUERY_FAILED;
+  }
+
+  Dictionary managed_objects = reply->get_arg(0);
+  objects = Dictionary();
+  paths_by_interface.clear();
+  Array paths = managed_objects.keys();
+  for (int i = 0; i < paths.size(); i++) {
+    add_interfaces(paths[i], managed_objects[paths[i]]);
+  }
+
+  return godot::OK;
+}
+
+// Adds (or replaces) the given interfaces and their properties on an object
+void DBusObjectManagerMirror::add_interfaces(String object_path,
+                                             Dictionary interfaces) {
+  if (!objects.has(object_path)) {
+    objects[object_path] = Dictionary();
+  }
+  Dictionary object = objects[object_path];
+
+  Array names = interfaces.keys();
+  for (int i = 0; i < names.size(); i++) {
+    String iface = names[i];
+    object[iface] = interfaces[iface];
+    if (!paths_by_interface.has(iface)) {
+      paths_by_interface.insert(iface, godot::HashSet<String>());
+    }
+    paths_by_interface[iface].insert(object_path);
+  }
+}
+
+// Removes the given interfaces from an object. The object itself is removed
+// once it has no interfaces left.
+void DBusObjectManagerMirror::remove_interfaces(String object_path,
+                                                PackedStringArray interfaces) {
+  if (!objects.has(object_path)) {
+    return;
+  }
+  Dictionary object = objects[object_path];
+
+  for (int i = 0; i < interfaces.size(); i++) {
+    String iface = interfaces[i];
+    object.erase(iface);
+    godot::HashSet<String> *paths = paths_by_interface.getptr(iface);
+    if (paths == nullptr) {
+      continue;
+    }
+    paths->erase(object_path);
+    if (paths->is_empty()) {
+      paths_by_interface.erase(iface);
+    }
+  }
+
+  if (object.is_empty()) {
+    objects.erase(object_path);
+  }
+}
+
+// Returns the whole mirrored tree as a dictionary of object paths to
+// interfaces to properties, the same as GetManagedObjects would. Like the
+// other getters it returns a copy, so changing it does not affect the mirror.
+Dictionary DBusObjectManagerMirror::get_objects() {
+  return objects.duplicate(true);
+}
+
+// Returns true if an object exists at the given path
+bool DBusObjectManagerMirror::has_object(String object_path) {
+  return objects.has(object_path);
+}
+
+// Returns the interfaces and properties of the object at the given path
+Dictionary DBusObjectManagerMirror::get_object(String object_path) {
+  Dictionary object = objects.get(object_path, Dictionary());
+  return object.duplicate(true);
+}
+
+// Returns the properties of an interface on the object at the given path
+Dictionary DBusObjectManagerMirror::get_properties(String object_path,
+                                                   String iface) {
+  Dictionary object = objects.get(object_path, Dictionary());
+  Dictionary properties = object.get(iface, Dictionary());
+  return properties.duplicate(true);
+}
+
+// Returns a single property of an interface on the object at the given path
+Variant DBusObjectManagerMirror::get_property(String object_path,
+                                              String iface, String name) {
+  Dictionary object = objects.get(object_path, Dictionary());
+  Dictionary properties = object.get(iface, Dictionary());
+  return properties.get(name, Variant()).duplicate(true);
+}
+
+// Returns the paths of all objects implementing the given interface
+PackedStringArray
+DBusObjectManagerMirror::get_paths_with_interface(String iface) {
+  PackedStringArray paths = PackedStringArray();
+  const godot::HashSet<String> *set = paths_by_interface.getptr(iface);
+  if (set == nullptr) {
+    return paths;
+  }
+  for (const String &object_path : *set) {
+    paths.append(object_path);
+  }
+  return paths;
+}
+
+// Handles the InterfacesAdded signal
+void DBusObjectManagerMirror::_on_interfaces_added(DBusMessage *msg) {
+  String object_path = msg->get_arg(0);
+  Dictionary interfaces = msg->get_arg(1);
+  add_interfaces(object_path, interfaces);
+  emit_signal("interfaces_added", object_path, interfaces);
+}
+
+// Handles the InterfacesRemoved signal
+void DBusObjectManagerMirror::_on_interfaces_removed(DBusMessage *msg) {
+  String object_path = msg->get_arg(0);
+  PackedStringArray interfaces = msg->get_arg(1);
+  remove_interfaces(object_path, interfaces);
+  emit_signal("interfaces_removed", object_path, interfaces);
+}
+
+// Handles the PropertiesChanged signal of any object of the service.
+// Invalidated properties are removed from the mirror, since their new value
+// is not part of the signal.
+void DBusObjectManagerMirror::_on_properties_changed(DBusMessage *msg) {
+  String object_path = msg->get_path();
+  if (!objects.has(object_path)) {
+    return;
+  }
+  Dictionary object = objects[object_path];
+  String iface = msg->get_arg(0);
+  if (!object.has(iface)) {
+    return;
+  }
+  Dictionary properties = object[iface];
+
+  Dictionary changed = msg->get_arg(1);
+  Array keys = changed.keys();
+  for (int i = 0; i < keys.size(); i++) {
+    properties[keys[i]] = changed[keys[i]];
+  }
+  PackedStringArray invalidated = msg->get_arg(2);
+  for (int i = 0; i < invalidated.size(); i++) {
+    properties.erase(invalidated[i]);
+  }
+
+  emit_signal("properties_changed", object_path, iface, changed, invalidated);
+}
+
+// Register the methods with Godot
+void DBusObjectManagerMirror::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("refresh"), &DBusObjectManagerMirror::refresh);
+  ClassDB::bind_method(D_METHOD("get_objects"),
+                       &DBusObjectManagerMirror::get_objects);
+  ClassDB::bind_method(D_METHOD("has_object", "object_path"),
+                       &DBusObjectManagerMirror::has_object);
+  ClassDB::bind_method(D_METHOD("get_object", "object_path"),
+                       &DBusObjectManagerMirror::get_object);
+  ClassDB::bind_method(D_METHOD("get_properties", "object_path", "iface"),
+                       &DBusObjectManagerMirror::get_properties);
+  ClassDB::bind_method(D_METHOD("get_property", "object_path", "iface", "name"),
+                       &DBusObjectManagerMirror::get_property);
+  ClassDB::bind_method(D_METHOD("get_paths_with_interface", "iface"),
+                       &DBusObjectManagerMirror::get_paths_with_interface);
+  ClassDB::bind_method(D_METHOD("_on_interfaces_added", "msg"),
+                       &DBusObjectManagerMirror::_on_interfaces_added);
+  ClassDB::bind_method(D_METHOD("_on_interfaces_removed", "msg"),
+                       &DBusObjectManagerMirror::_on_interfaces_removed);
+  ClassDB::bind_method(D_METHOD("_on_properties_changed", "msg"),
+                       &DBusObjectManagerMirror::_on_properties_changed);
+
+  // Signals
+  ADD_SIGNAL(MethodInfo("interfaces_added",
+                        PropertyInfo(Variant::STRING, "object_path"),
+                        PropertyInfo(Variant::DICTIONARY, "interfaces")));
+  ADD_SIGNAL(MethodInfo("interfaces_removed",
+                        PropertyInfo(Variant::STRING, "object_path"),
+                        PropertyInfo(Variant::PACKED_STRING_ARRAY,
+                                     "interfaces")));
+  ADD_SIGNAL(MethodInfo(
+      "properties_changed", PropertyInfo(Variant::STRING, "object_path"),
+      PropertyInfo(Variant::STRING, "iface"),
+      PropertyInfo(Variant::DICTIONARY, "changed"),
+      PropertyInfo(Variant::PACKED_STRING_ARRAY, "invalidated")));
+};
@@ -0,0 +1,70 @@
+#ifndef DBUS_OBJECT_MANAGER_MIRROR_CLASS_H
+#define DBUS_OBJECT_MANAGER_MIRROR_CLASS_H
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/templates/hash_set.hpp"
+#include "godot_cpp/templates/vector.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/variant.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "dbus_message.h"
+
+class DBus;
+
+// Local replica of the object tree exported by an org.freedesktop.DBus.
+// ObjectManager. The tree is fetched once with GetManagedObjects and then
+// updated incrementally from the InterfacesAdded, InterfacesRemoved and
+// PropertiesChanged signals.
+class DBusObjectManagerMirror : public godot::RefCounted {
+  GDCLASS(DBusObjectManagerMirror, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  // Object path -> interface name -> property name -> value
+  godot::Dictionary objects;
+  // Interface name -> paths of the objects implementing it
+  godot::HashMap<godot::String, godot::HashSet<godot::String>>
+      paths_by_interface;
+  godot::Vector<int> subscription_ids;
+
+  void add_interfaces(godot::String object_path, godot::Dictionary interfaces);
+  void remove_interfaces(godot::String object_path,
+                         godot::PackedStringArray interfaces);
+
+public:
+  // Constructor/deconstructor
+  DBusObjectManagerMirror();
+  ~DBusObjectManagerMirror();
+
+  // Properties
+  godot::Ref<DBus> dbus;
+  godot::String bus_name;
+  godot::String path;
+
+  // Methods
+  int start();
+  int refresh();
+  godot::Dictionary get_objects();
+  bool has_object(godot::String object_path);
+  godot::Dictionary get_object(godot::String object_path);
+  godot::Dictionary get_properties(godot::String object_path,
+                                   godot::String iface);
+  godot::Variant get_property(godot::String object_path, godot::String iface,
+                              godot::String name);
+  godot::PackedStringArray get_paths_with_interface(godot::String iface);
+  void _on_interfaces_added(DBusMessage *msg);
+  void _on_interfaces_removed(DBusMessage *msg);
+  void _on_properties_changed(DBusMessage *msg);
+};
+
+#endif // DBUS_OBJECT_MANAGER_MIRROR_CLASS_H
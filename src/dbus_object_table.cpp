@@ -0,0 +1,266 @@
+#include "dbus_object_table.h"
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/variant/array.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+#include "godot_cpp/variant/utility_functions.hpp"
+
+using godot::Array;
+using godot::Callable;
+using godot::Dictionary;
+using godot::String;
+using godot::StringName;
+using godot::Variant;
+
+// Exports an interface at the given path. Each entry of "handlers" maps a
+// method name to either a Callable, for methods without reply arguments, or
+// to a Dictionary with a "callable", the "signature" of the reply and
+// optionally the "in_signature" of the arguments. Each entry of "properties"
+// maps a property name to a Dictionary with its "signature", a "getter" and
+// an optional "setter".
+int DBusObjectTable::add(String path, String iface, Dictionary handlers,
+                         Dictionary properties) {
+  DBusObjectInterface object_iface;
+
+  Array names = handlers.keys();
+  for (int i = 0; i < names.size(); i++) {
+    Variant handler = handlers[names[i]];
+    DBusObjectMethod method;
+    String out_signature = "";
+    if (handler.get_type() == Variant::CALLABLE) {
+      method.callable = handler;
+    } else if (handler.get_type() == Variant::DICTIONARY) {
+      Dictionary handler_dict = handler;
+      method.callable = handler_dict.get("callable", Callable());
+      out_signature = handler_dict.get("signature", "");
+      method.in_signature = handler_dict.get("in_signature", "");
+    }
+    if (!method.callable.is_valid()) {
+      godot::UtilityFunctions::push_error("Invalid handler for method ",
+                                          names[i], " of ", iface);
+      return godot::ERR_INVALID_PARAMETER;
+    }
+    if (!::dbus_signature_validate(method.in_signature.ascii().get_data(),
+                                   nullptr)) {
+      godot::UtilityFunctions::push_error("Invalid signature: ",
+                                          method.in_signature);
+      return godot::ERR_INVALID_PARAMETER;
+    }
+
+    method.out_plan = DBusSignaturePlan::get(out_signature);
+    if (method.out_plan == nullptr) {
+      return godot::ERR_INVALID_PARAMETER;
+    }
+    object_iface.methods.insert(StringName(names[i]), method);
+  }
+
+  names = properties.keys();
+  for (int i = 0; i < names.size(); i++) {
+    Variant entry = properties[names[i]];
+    if (entry.get_type() != Variant::DICTIONARY) {
+      godot::UtilityFunctions::push_error("Invalid property ", names[i],
+                                          " of ", iface);
+      return godot::ERR_INVALID_PARAMETER;
+    }
+    Dictionary property_dict = entry;
+    DBusObjectProperty property;
+    property.getter = property_dict.get("getter", Callable());
+    property.setter = property_dict.get("setter", Callable());
+    if (!property.getter.is_valid()) {
+      godot::UtilityFunctions::push_error("Invalid getter for property ",
+                                          names[i], " of ", iface);
+      return godot::ERR_INVALID_PARAMETER;
+    }
+
+    // A property holds exactly one complete type
+    property.plan = DBusSignaturePlan::get(property_dict.get("signature", ""));
+    if (property.plan == nullptr || property.plan->get_arg_count() != 1) {
+      godot::UtilityFunctions::push_error("Invalid signature for property ",
+                                          names[i], " of ", iface);
+      return godot::ERR_INVALID_PARAMETER;
+    }
+    object_iface.properties.insert(StringName(names[i]), property);
+  }
+
+  StringName path_name = StringName(path);
+  if (!objects.has(path_name)) {
+    objects.insert(path_name, DBusObject());
+  }
+  objects[path_name].interfaces.insert(StringName(iface), object_iface);
+
+  return godot::OK;
+}
+
+// Removes an exported interface, or every interface at the path if "iface"
+// is empty.
+bool DBusObjectTable::remove(String path, String iface) {
+  StringName path_name = StringName(path);
+  DBusObject *object = objects.getptr(path_name);
+  if (object == nullptr) {
+    return false;
+  }
+
+  if (!iface.is_empty()) {
+    if (!object->interfaces.erase(StringName(iface))) {
+      return false;
+    }
+    if (!object->interfaces.is_empty()) {
+      return true;
+    }
+  }
+  objects.erase(path_name);
+
+  return true;
+}
+
+// Returns true if no objects are exported
+bool DBusObjectTable::is_empty() { return objects.is_empty(); }
+
+// Removes all exported objects
+void DBusObjectTable::clear() { objects.clear(); }
+
+// Looks up the handler for the given method call. The interface is optional
+// in method calls, in which case every interface at the path is searched.
+DBusObjectTable::LookupResult
+DBusObjectTable::lookup(::DBusMessage *msg, const DBusObjectMethod **r_method) {
+  const char *path = ::dbus_message_get_path(msg);
+  const char *iface = ::dbus_message_get_interface(msg);
+  const char *member = ::dbus_message_get_member(msg);
+  if (path == nullptr || member == nullptr) {
+    return LOOKUP_UNKNOWN_OBJECT;
+  }
+
+  const DBusObject *object = objects.getptr(StringName(path));
+  if (object == nullptr) {
+    return LOOKUP_UNKNOWN_OBJECT;
+  }
+
+  StringName member_name = StringName(member);
+  if (iface == nullptr) {
+    for (const godot::KeyValue<StringName, DBusObjectInterface> &entry :
+         object->interfaces) {
+      const DBusObjectMethod *method = entry.value.methods.getptr(member_name);
+      if (method != nullptr) {
+        *r_method = method;
+        return LOOKUP_FOUND;
+      }
+    }
+    return LOOKUP_UNKNOWN_METHOD;
+  }
+
+  const DBusObjectInterface *object_iface =
+      object->interfaces.getptr(StringName(iface));
+  if (object_iface == nullptr) {
+    return LOOKUP_UNKNOWN_INTERFACE;
+  }
+  const DBusObjectMethod *method = object_iface->methods.getptr(member_name);
+  if (method == nullptr) {
+    return LOOKUP_UNKNOWN_METHOD;
+  }
+  *r_method = method;
+
+  return LOOKUP_FOUND;
+}
+
+// Returns the object exported at the given path, or nullptr if there is none
+const DBusObject *DBusObjectTable::find_object(const char *path) {
+  return objects.getptr(StringName(path));
+}
+
+// Appends an introspection argument for every complete type of the signature
+static void append_introspected_args(String &xml, const String &signature,
+                                     const char *direction) {
+  if (signature.is_empty()) {
+    return;
+  }
+  godot::CharString sig = signature.ascii();
+  DBusSignatureIter iter;
+  ::dbus_signature_iter_init(&iter, sig.get_data());
+  do {
+    char *type = ::dbus_signature_iter_get_signature(&iter);
+    xml += String("      <arg type=\"") + type + "\" direction=\"" +
+           direction + "\"/>\n";
+    ::dbus_free(type);
+  } while (::dbus_signature_iter_next(&iter));
+}
+
+// Builds the introspection XML for the given path. It describes the exported
+// interfaces and the standard interfaces answered for them, and lists the
+// exported objects below the path as child nodes. Returns an empty string if
+// nothing is exported at or below the path.
+String DBusObjectTable::introspect(const char *path) {
+  // Child nodes are the next path element of every object below this one
+  String prefix = String::utf8(path);
+  if (!prefix.ends_with("/")) {
+    prefix += "/";
+  }
+  godot::PackedStringArray children;
+  for (const godot::KeyValue<StringName, DBusObject> &entry : objects) {
+    String child = entry.key;
+    if (!child.begins_with(prefix) || child.length() == prefix.length()) {
+      continue;
+    }
+    child = child.substr(prefix.length()).get_slice("/", 0);
+    if (!children.has(child)) {
+      children.append(child);
+    }
+  }
+
+  const DBusObject *object = find_object(path);
+  if (object == nullptr && children.is_empty()) {
+    return String();
+  }
+
+  String xml = DBUS_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE;
+  xml += "<node>\n";
+  xml += "  <interface name=\"" DBUS_INTERFACE_INTROSPECTABLE "\">\n"
+         "    <method name=\"Introspect\">\n"
+         "      <arg type=\"s\" direction=\"out\"/>\n"
+         "    </method>\n"
+         "  </interface>\n";
+  if (object != nullptr) {
+    xml += "  <interface name=\"" DBUS_INTERFACE_PROPERTIES "\">\n"
+           "    <method name=\"Get\">\n"
+           "      <arg type=\"s\" direction=\"in\"/>\n"
+           "      <arg type=\"s\" direction=\"in\"/>\n"
+           "      <arg type=\"v\" direction=\"out\"/>\n"
+           "    </method>\n"
+           "    <method name=\"GetAll\">\n"
+           "      <arg type=\"s\" direction=\"in\"/>\n"
+           "      <arg type=\"a{sv}\" direction=\"out\"/>\n"
+           "    </method>\n"
+           "    <method name=\"Set\">\n"
+           "      <arg type=\"s\" direction=\"in\"/>\n"
+           "      <arg type=\"s\" direction=\"in\"/>\n"
+           "      <arg type=\"v\" direction=\"in\"/>\n"
+           "    </method>\n"
+           "  </interface>\n";
+    for (const godot::KeyValue<StringName, DBusObjectInterface> &iface :
+         object->interfaces) {
+      xml += String("  <interface name=\"") + iface.key + "\">\n";
+      for (const godot::KeyValue<StringName, DBusObjectMethod> &method :
+           iface.value.methods) {
+        xml += String("    <method name=\"") + method.key + "\">\n";
+        append_introspected_args(xml, method.value.in_signature, "in");
+        append_introspected_args(
+            xml, String(method.value.out_plan->signature.c_str()), "out");
+        xml += "    </method>\n";
+      }
+      for (const godot::KeyValue<StringName, DBusObjectProperty> &property :
+           iface.value.properties) {
+        xml += String("    <property name=\"") + property.key +
+               "\" type=\"" + property.value.plan->signature.c_str() +
+               "\" access=\"" +
+               (property.value.setter.is_valid() ? "readwrite" : "read") +
+               "\"/>\n";
+      }
+      xml += "  </interface>\n";
+    }
+  }
+  for (int i = 0; i < children.size(); i++) {
+    xml += String("  <node name=\"") + children[i] + "\"/>\n";
+  }
+  xml += "</node>\n";
+
+  return xml;
+}
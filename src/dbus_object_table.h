@@ -0,0 +1,68 @@
+#ifndef DBUS_OBJECT_TABLE_H
+#define DBUS_OBJECT_TABLE_H
+
+#include <dbus/dbus.h>
+#include <memory>
+
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/variant/callable.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/string_name.hpp"
+
+#include "dbus_signature_plan.h"
+
+// A method exported on the bus
+struct DBusObjectMethod {
+  godot::Callable callable;
+  // Signature of the arguments, only used for introspection
+  godot::String in_signature;
+  // Compiled signature of the reply
+  std::shared_ptr<const DBusSignaturePlan> out_plan;
+};
+
+// A property exported on the bus. Properties without a setter are read-only.
+struct DBusObjectProperty {
+  godot::Callable getter;
+  godot::Callable setter;
+  // Compiled signature of the value
+  std::shared_ptr<const DBusSignaturePlan> plan;
+};
+
+// The methods and properties of one exported interface, keyed by name
+struct DBusObjectInterface {
+  godot::HashMap<godot::StringName, DBusObjectMethod> methods;
+  godot::HashMap<godot::StringName, DBusObjectProperty> properties;
+};
+
+// The interfaces exported at one object path, keyed by interface name
+struct DBusObject {
+  godot::HashMap<godot::StringName, DBusObjectInterface> interfaces;
+};
+
+// Table of objects exported on the bus. Incoming method calls are resolved
+// with hash lookups on the interned path, interface and member.
+class DBusObjectTable {
+private:
+  godot::HashMap<godot::StringName, DBusObject> objects;
+
+public:
+  // Result of looking up an incoming method call
+  enum LookupResult {
+    LOOKUP_FOUND,
+    LOOKUP_UNKNOWN_OBJECT,
+    LOOKUP_UNKNOWN_INTERFACE,
+    LOOKUP_UNKNOWN_METHOD,
+  };
+
+  int add(godot::String path, godot::String iface, godot::Dictionary handlers,
+          godot::Dictionary properties);
+  bool remove(godot::String path, godot::String iface);
+  bool is_empty();
+  void clear();
+  LookupResult lookup(::DBusMessage *msg, const DBusObjectMethod **r_method);
+  const DBusObject *find_object(const char *path);
+  godot::String introspect(const char *path);
+};
+
+#endif // DBUS_OBJECT_TABLE_H
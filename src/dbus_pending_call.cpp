@@ -0,0 +1,112 @@
+#include "dbus_pending_call.h"
+#include "dbus/dbus-protocol.h"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::Variant;
+
+DBusPendingCall::DBusPendingCall(){};
+DBusPendingCall::~DBusPendingCall() {
+  if (pending == nullptr) {
+    return;
+  }
+  ::dbus_pending_call_cancel(pending);
+  ::dbus_pending_call_unref(pending);
+};
+
+// Returns the current state of the call
+int DBusPendingCall::get_state() { return state; }
+
+// Returns the serial of the sent method call
+uint32_t DBusPendingCall::get_serial() { return serial; }
+
+// Returns true if no reply has been received yet
+bool DBusPendingCall::is_pending() { return state == STATE_PENDING; }
+
+// Returns true if a reply (or timeout error) is available
+bool DBusPendingCall::is_completed() {
+  return state == STATE_COMPLETED || state == STATE_TIMED_OUT;
+}
+
+// Returns the reply to the method call, or null if it has not arrived yet
+DBusMessage *DBusPendingCall::get_reply() {
+  if (reply.is_null()) {
+    return nullptr;
+  }
+  return reply.ptr();
+}
+
+// Cancels the call. Any reply that arrives afterwards will be dropped and the
+// "completed" signal will not be emitted.
+void DBusPendingCall::cancel() {
+  if (state != STATE_PENDING) {
+    return;
+  }
+  state = STATE_CANCELLED;
+  if (pending != nullptr) {
+    ::dbus_pending_call_cancel(pending);
+  }
+}
+
+// Completes the call with the given reply. Takes ownership of the message.
+void DBusPendingCall::complete(::DBusMessage *msg) {
+  if (state != STATE_PENDING) {
+    ::dbus_message_unref(msg);
+    return;
+  }
+
+  // The reply was taken off the connection by us, so libdbus no longer needs
+  // to track this call or its timeout.
+  if (pending != nullptr) {
+    ::dbus_pending_call_cancel(pending);
+  }
+
+  reply.instantiate();
+  reply->message = msg;
+  state = STATE_COMPLETED;
+  emit_signal("completed", reply);
+}
+
+// Completes the call with a synthesized NoReply error, the same way libdbus
+// reports a timed out call.
+void DBusPendingCall::time_out() {
+  if (state != STATE_PENDING) {
+    return;
+  }
+  if (pending != nullptr) {
+    ::dbus_pending_call_cancel(pending);
+  }
+
+  ::DBusMessage *msg = ::dbus_message_new(DBUS_MESSAGE_TYPE_ERROR);
+  ::dbus_message_set_error_name(msg, DBUS_ERROR_NO_REPLY);
+  ::dbus_message_set_reply_serial(msg, serial);
+  const char *text = "Did not receive a reply before the timeout expired";
+  ::dbus_message_append_args(msg, DBUS_TYPE_STRING, &text, DBUS_TYPE_INVALID);
+
+  reply.instantiate();
+  reply->message = msg;
+  state = STATE_TIMED_OUT;
+  emit_signal("completed", reply);
+}
+
+// Register the methods with Godot
+void DBusPendingCall::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("get_state"), &DBusPendingCall::get_state);
+  ClassDB::bind_method(D_METHOD("get_serial"), &DBusPendingCall::get_serial);
+  ClassDB::bind_method(D_METHOD("is_pending"), &DBusPendingCall::is_pending);
+  ClassDB::bind_method(D_METHOD("is_completed"),
+                       &DBusPendingCall::is_completed);
+  ClassDB::bind_method(D_METHOD("get_reply"), &DBusPendingCall::get_reply);
+  ClassDB::bind_method(D_METHOD("cancel"), &DBusPendingCall::cancel);
+
+  // Signals
+  ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::OBJECT, "reply")));
+
+  // Constants
+  BIND_CONSTANT(STATE_PENDING);
+  BIND_CONSTANT(STATE_COMPLETED);
+  BIND_CONSTANT(STATE_TIMED_OUT);
+  BIND_CONSTANT(STATE_CANCELLED);
+};
@@ -0,0 +1,61 @@
+#ifndef DBUS_PENDING_CALL_CLASS_H
+#define DBUS_PENDING_CALL_CLASS_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/variant.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "dbus_message.h"
+
+// Handle to a method call that was sent without blocking for the reply. The
+// reply is delivered while the owning DBus connection is being pumped (e.g.
+// with pop_message), at which point the "completed" signal is emitted.
+class DBusPendingCall : public godot::RefCounted {
+  GDCLASS(DBusPendingCall, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::Ref<DBusMessage> reply;
+
+public:
+  enum State {
+    STATE_PENDING,
+    STATE_COMPLETED,
+    STATE_TIMED_OUT,
+    STATE_CANCELLED,
+  };
+
+  // Constructor/deconstructor
+  DBusPendingCall();
+  ~DBusPendingCall();
+
+  // Properties
+  ::DBusPendingCall *pending = nullptr;
+  uint32_t serial = 0;
+  uint64_t deadline_usec = 0; // Zero if the call never times out
+  State state = STATE_PENDING;
+
+  // Methods
+  int get_state();
+  uint32_t get_serial();
+  bool is_pending();
+  bool is_completed();
+  DBusMessage *get_reply();
+  void cancel();
+
+  // Called by the owning connection
+  void complete(::DBusMessage *msg);
+  void time_out();
+};
+
+#endif // DBUS_PENDING_CALL_CLASS_H
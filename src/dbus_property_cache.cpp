@@ -0,0 +1,143 @@
+#include "dbus_property_cache.h"
+#include "dbus.h"
+
+using godot::Array;
+using godot::Callable;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Dictionary;
+using godot::MethodInfo;
+using godot::PackedStringArray;
+using godot::PropertyInfo;
+using godot::String;
+using godot::Variant;
+
+static const char *PROPERTIES_IFACE = "org.freedesktop.DBus.Properties";
+
+DBusPropertyCache::DBusPropertyCache(){};
+DBusPropertyCache::~DBusPropertyCache() {
+  if (subscription_id < 0 || dbus.is_null()) {
+    return;
+  }
+  dbus->unsubscribe(subscription_id);
+};
+
+// Subscribes to property changes and fetches the initial values. The
+// subscription is made first so that no change can be missed in between.
+int DBusPropertyCache::start() {
+  if (dbus.is_null()) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CONNECTION_ERROR;
+  }
+
+  subscription_id =
+      dbus->subscribe(bus_name, path, PROPERTIES_IFACE, "PropertiesChanged",
+                      Callable(this, "_on_properties_changed"));
+  if (subscription_id < 0) {
+    return godot::ERR_CANT_CREATE;
+  }
+
+  return refresh();
+}
+
+// Fetches all properties again with a single GetAll call
+int DBusPropertyCache::refresh() {
+  Array args = Array();
+  args.append(iface);
+  godot::Ref<DBusMessage> reply = dbus->send_with_reply_and_block(
+      bus_name, path, PROPERTIES_IFACE, "GetAll", args, "s");
+  if (reply.is_null()) {
+    return godot::ERR_CANT_CONNECT;
+  }
+  if (reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    godot::UtilityFunctions::push_warning("Unable to get properties of ",
+                                          iface, " at ", path, ": ",
+                                          reply->get_error_name());
+    return godot::ERR_QUERY_FAILED;
+  }
+
+  properties = reply->get_arg(0);
+  invalidated.clear();
+
+  return godot::OK;
+}
+
+// Returns true if the interface has the given property
+bool DBusPropertyCache::has_property(String name) {
+  return properties.has(name) || invalidated.has(name);
+}
+
+// Returns the cached value of the given property. Properties that were
+// invalidated without a new value are fetched again once on first access.
+Variant DBusPropertyCache::get_property(String name) {
+  if (!invalidated.has(name)) {
+    return properties.get(name, Variant());
+  }
+
+  Array args = Array();
+  args.append(iface);
+  args.append(name);
+  godot::Ref<DBusMessage> reply = dbus->send_with_reply_and_block(
+      bus_name, path, PROPERTIES_IFACE, "Get", args, "ss");
+  if (reply.is_null() || reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    return Variant();
+  }
+  Variant value = reply->get_arg(0);
+  properties[name] = value;
+  invalidated.erase(name);
+
+  return value;
+}
+
+// Returns all cached properties
+Dictionary DBusPropertyCache::get_properties() { return properties; }
+
+String DBusPropertyCache::get_bus_name() { return bus_name; }
+String DBusPropertyCache::get_path() { return path; }
+String DBusPropertyCache::get_interface() { return iface; }
+
+// Applies the changes from a PropertiesChanged signal
+void DBusPropertyCache::_on_properties_changed(DBusMessage *msg) {
+  // The signal is sent for every interface on the object
+  if (String(msg->get_arg(0)) != iface) {
+    return;
+  }
+
+  Dictionary changed = msg->get_arg(1);
+  Array keys = changed.keys();
+  for (int i = 0; i < keys.size(); i++) {
+    properties[keys[i]] = changed[keys[i]];
+    invalidated.erase(keys[i]);
+  }
+
+  PackedStringArray invalidated_names = msg->get_arg(2);
+  for (int i = 0; i < invalidated_names.size(); i++) {
+    properties.erase(invalidated_names[i]);
+    invalidated.insert(invalidated_names[i]);
+  }
+
+  emit_signal("properties_changed", changed, invalidated_names);
+}
+
+// Register the methods with Godot
+void DBusPropertyCache::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("refresh"), &DBusPropertyCache::refresh);
+  ClassDB::bind_method(D_METHOD("has_property", "name"),
+                       &DBusPropertyCache::has_property);
+  ClassDB::bind_method(D_METHOD("get_property", "name"),
+                       &DBusPropertyCache::get_property);
+  ClassDB::bind_method(D_METHOD("get_properties"),
+                       &DBusPropertyCache::get_properties);
+  ClassDB::bind_method(D_METHOD("get_bus_name"),
+                       &DBusPropertyCache::get_bus_name);
+  ClassDB::bind_method(D_METHOD("get_path"), &DBusPropertyCache::get_path);
+  ClassDB::bind_method(D_METHOD("get_interface"),
+                       &DBusPropertyCache::get_interface);
+  ClassDB::bind_method(D_METHOD("_on_properties_changed", "msg"),
+                       &DBusPropertyCache::_on_properties_changed);
+
+  // Signals
+  ADD_SIGNAL(MethodInfo(
+      "properties_changed", PropertyInfo(Variant::DICTIONARY, "changed"),
+      PropertyInfo(Variant::PACKED_STRING_ARRAY, "invalidated")));
+};
@@ -0,0 +1,57 @@
+#ifndef DBUS_PROPERTY_CACHE_CLASS_H
+#define DBUS_PROPERTY_CACHE_CLASS_H
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/templates/hash_set.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/variant.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "dbus_message.h"
+
+class DBus;
+
+// Local copy of all properties of a single interface on a remote object. The
+// properties are fetched once with GetAll and then kept up to date from the
+// PropertiesChanged signal, so reading them does not touch the bus.
+class DBusPropertyCache : public godot::RefCounted {
+  GDCLASS(DBusPropertyCache, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::Dictionary properties;
+  godot::HashSet<godot::String> invalidated;
+  int subscription_id = -1;
+
+public:
+  // Constructor/deconstructor
+  DBusPropertyCache();
+  ~DBusPropertyCache();
+
+  // Properties
+  godot::Ref<DBus> dbus;
+  godot::String bus_name;
+  godot::String path;
+  godot::String iface;
+
+  // Methods
+  int start();
+  int refresh();
+  bool has_property(godot::String name);
+  godot::Variant get_property(godot::String name);
+  godot::Dictionary get_properties();
+  godot::String get_bus_name();
+  godot::String get_path();
+  godot::String get_interface();
+  void _on_properties_changed(DBusMessage *msg);
+};
+
+#endif // DBUS_PROPERTY_CACHE_CLASS_H
@@ -0,0 +1,292 @@
+#include "dbus_proxy.h"
+#include "dbus.h"
+
+using godot::Array;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Dictionary;
+using godot::PackedStringArray;
+using godot::Ref;
+using godot::String;
+using godot::Variant;
+
+static const char *PROPERTIES_IFACE = "org.freedesktop.DBus.Properties";
+
+DBusProxy::DBusProxy(){};
+DBusProxy::~DBusProxy(){};
+
+// Returns the interface with the given name, or nullptr if the object does
+// not implement it
+const DBusIntrospectedInterface *
+DBusProxy::find_interface(const String &iface) {
+  if (introspection == nullptr) {
+    return nullptr;
+  }
+  return introspection->find_interface(iface);
+}
+
+// Looks up a method in the given interface, or in every interface of the
+// object if none is given. Returns nullptr if there is no such method.
+const DBusIntrospectedMethod *
+DBusProxy::resolve_method(const String &method, const String &iface,
+                          const DBusIntrospectedInterface *&found) {
+  if (introspection == nullptr) {
+    return nullptr;
+  }
+  for (int i = 0; i < introspection->interfaces.size(); i++) {
+    const DBusIntrospectedInterface &entry = introspection->interfaces[i];
+    if (!iface.is_empty() && entry.name != iface) {
+      continue;
+    }
+    const DBusIntrospectedMethod *result = entry.methods.getptr(method);
+    if (result != nullptr) {
+      found = &entry;
+      return result;
+    }
+  }
+  godot::UtilityFunctions::push_error("No method ", method, " on ", path);
+  return nullptr;
+}
+
+// Looks up a property in the given interface, or in every interface of the
+// object if none is given. Returns nullptr if there is no such property.
+const DBusIntrospectedProperty *
+DBusProxy::resolve_property(const String &name, const String &iface,
+                            const DBusIntrospectedInterface *&found) {
+  if (introspection == nullptr) {
+    return nullptr;
+  }
+  for (int i = 0; i < introspection->interfaces.size(); i++) {
+    const DBusIntrospectedInterface &entry = introspection->interfaces[i];
+    if (!iface.is_empty() && entry.name != iface) {
+      continue;
+    }
+    const DBusIntrospectedProperty *result = entry.properties.getptr(name);
+    if (result != nullptr) {
+      found = &entry;
+      return result;
+    }
+  }
+  godot::UtilityFunctions::push_error("No property ", name, " on ", path);
+  return nullptr;
+}
+
+// Builds a call to the given method using its precompiled signature
+::DBusMessage *DBusProxy::build_call(const String &method, const Array &args,
+                                     const String &iface) {
+  if (dbus.is_null() || dbus->dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return nullptr;
+  }
+  const DBusIntrospectedInterface *found = nullptr;
+  const DBusIntrospectedMethod *resolved =
+      resolve_method(method, iface, found);
+  if (resolved == nullptr) {
+    return nullptr;
+  }
+  if (resolved->in_plan == nullptr) {
+    godot::UtilityFunctions::push_error("Invalid signature for method ",
+                                        method, ": ", resolved->in_signature);
+    return nullptr;
+  }
+  return build_method_call(bus_name, path, found->name, method, args,
+                           *resolved->in_plan);
+}
+
+// Calls the given method and waits for the reply
+DBusMessage *DBusProxy::call_method(String method, Array args, String iface) {
+  ::DBusMessage *msg = build_call(method, args, iface);
+  if (msg == nullptr) {
+    return nullptr;
+  }
+  return dbus->send_message_blocking(msg);
+}
+
+// Calls the given method without waiting for the reply. The returned pending
+// call emits "completed" once the reply arrives.
+DBusPendingCall *DBusProxy::call_method_async(String method, Array args,
+                                              String iface, int timeout_ms) {
+  ::DBusMessage *msg = build_call(method, args, iface);
+  if (msg == nullptr) {
+    return nullptr;
+  }
+  return dbus->send_message_async(msg, timeout_ms);
+}
+
+// Fetches the current value of the given property
+Variant DBusProxy::get_property(String name, String iface) {
+  if (dbus.is_null()) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return Variant();
+  }
+  const DBusIntrospectedInterface *found = nullptr;
+  if (resolve_property(name, iface, found) == nullptr) {
+    return Variant();
+  }
+
+  Array args = Array();
+  args.append(found->name);
+  args.append(name);
+  Ref<DBusMessage> reply = dbus->send_with_reply_and_block(
+      bus_name, path, PROPERTIES_IFACE, "Get", args, "ss");
+  if (reply.is_null()) {
+    return Variant();
+  }
+  if (reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    godot::UtilityFunctions::push_warning("Unable to get property ", name,
+                                          " at ", path, ": ",
+                                          reply->get_error_name());
+    return Variant();
+  }
+  return reply->get_arg(0);
+}
+
+// Sets the given property. The value is marshaled with the property's own
+// type instead of being boxed based on its Godot type.
+int DBusProxy::set_property(String name, Variant value, String iface) {
+  if (dbus.is_null() || dbus->dbus_conn == nullptr) {
+    godot::UtilityFunctions::push_error("No dbus connection exists");
+    return godot::ERR_CONNECTION_ERROR;
+  }
+  const DBusIntrospectedInterface *found = nullptr;
+  const DBusIntrospectedProperty *property =
+      resolve_property(name, iface, found);
+  if (property == nullptr) {
+    return godot::ERR_DOES_NOT_EXIST;
+  }
+  if (property->plan == nullptr || property->plan->ops.empty()) {
+    godot::UtilityFunctions::push_error("Invalid signature for property ",
+                                        name, ": ", property->signature);
+    return godot::ERR_INVALID_DATA;
+  }
+
+  // Build the Set call with the interface and property name, then box the
+  // value in a variant of the property's type
+  Array args = Array();
+  args.append(found->name);
+  args.append(name);
+  ::DBusMessage *msg = build_method_call(bus_name, path, PROPERTIES_IFACE,
+                                         "Set", args, String("ss"));
+  if (msg == nullptr) {
+    return godot::ERR_INVALID_PARAMETER;
+  }
+  DBusMessageIter iter;
+  DBusMessageIter variant_iter;
+  ::dbus_message_iter_init_append(msg, &iter);
+  ::dbus_message_iter_open_container(&iter, DBUS_TYPE_VARIANT,
+                                     property->plan->signature.c_str(),
+                                     &variant_iter);
+  if (!append_arg(&variant_iter, value, *property->plan, 0)) {
+    ::dbus_message_iter_abandon_container(&iter, &variant_iter);
+    ::dbus_message_unref(msg);
+    return godot::ERR_INVALID_PARAMETER;
+  }
+  ::dbus_message_iter_close_container(&iter, &variant_iter);
+
+  Ref<DBusMessage> reply = dbus->send_message_blocking(msg);
+  if (reply.is_null()) {
+    return godot::ERR_CANT_CONNECT;
+  }
+  if (reply->get_type() == DBUS_MESSAGE_TYPE_ERROR) {
+    godot::UtilityFunctions::push_warning("Unable to set property ", name,
+                                          " at ", path, ": ",
+                                          reply->get_error_name());
+    return godot::ERR_QUERY_FAILED;
+  }
+  return godot::OK;
+}
+
+// Returns the bus name of the remote object
+String DBusProxy::get_bus_name() { return bus_name; }
+
+// Returns the path of the remote object
+String DBusProxy::get_path() { return path; }
+
+// Returns the names of all interfaces implemented by the object
+PackedStringArray DBusProxy::get_interfaces() {
+  PackedStringArray result;
+  if (introspection == nullptr) {
+    return result;
+  }
+  for (int i = 0; i < introspection->interfaces.size(); i++) {
+    result.append(introspection->interfaces[i].name);
+  }
+  return result;
+}
+
+// Returns the methods of the given interface, mapping each method name to a
+// Dictionary with its "in" and "out" signatures
+Dictionary DBusProxy::get_methods(String iface) {
+  Dictionary result = Dictionary();
+  const DBusIntrospectedInterface *found = find_interface(iface);
+  if (found == nullptr) {
+    return result;
+  }
+  for (const godot::KeyValue<String, DBusIntrospectedMethod> &entry :
+       found->methods) {
+    Dictionary method = Dictionary();
+    method["in"] = entry.value.in_signature;
+    method["out"] = entry.value.out_signature;
+    result[entry.key] = method;
+  }
+  return result;
+}
+
+// Returns the properties of the given interface, mapping each property name
+// to a Dictionary with its "type" signature and "access"
+Dictionary DBusProxy::get_properties(String iface) {
+  Dictionary result = Dictionary();
+  const DBusIntrospectedInterface *found = find_interface(iface);
+  if (found == nullptr) {
+    return result;
+  }
+  for (const godot::KeyValue<String, DBusIntrospectedProperty> &entry :
+       found->properties) {
+    Dictionary property = Dictionary();
+    property["type"] = entry.value.signature;
+    property["access"] = entry.value.access;
+    result[entry.key] = property;
+  }
+  return result;
+}
+
+// Returns the names of the signals of the given interface
+PackedStringArray DBusProxy::get_signals(String iface) {
+  const DBusIntrospectedInterface *found = find_interface(iface);
+  if (found == nullptr) {
+    return PackedStringArray();
+  }
+  return found->signals;
+}
+
+// Returns the relative paths of the object's children
+PackedStringArray DBusProxy::get_nodes() {
+  if (introspection == nullptr) {
+    return PackedStringArray();
+  }
+  return introspection->nodes;
+}
+
+// Register the methods with Godot
+void DBusProxy::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("call_method", "method", "args", "iface"),
+                       &DBusProxy::call_method, DEFVAL(Array()), DEFVAL(""));
+  ClassDB::bind_method(
+      D_METHOD("call_method_async", "method", "args", "iface", "timeout_ms"),
+      &DBusProxy::call_method_async, DEFVAL(Array()), DEFVAL(""),
+      DEFVAL(DBUS_TIMEOUT_USE_DEFAULT));
+  ClassDB::bind_method(D_METHOD("get_property", "name", "iface"),
+                       &DBusProxy::get_property, DEFVAL(""));
+  ClassDB::bind_method(D_METHOD("set_property", "name", "value", "iface"),
+                       &DBusProxy::set_property, DEFVAL(""));
+  ClassDB::bind_method(D_METHOD("get_bus_name"), &DBusProxy::get_bus_name);
+  ClassDB::bind_method(D_METHOD("get_path"), &DBusProxy::get_path);
+  ClassDB::bind_method(D_METHOD("get_interfaces"), &DBusProxy::get_interfaces);
+  ClassDB::bind_method(D_METHOD("get_methods", "iface"),
+                       &DBusProxy::get_methods);
+  ClassDB::bind_method(D_METHOD("get_properties", "iface"),
+                       &DBusProxy::get_properties);
+  ClassDB::bind_method(D_METHOD("get_signals", "iface"),
+                       &DBusProxy::get_signals);
+  ClassDB::bind_method(D_METHOD("get_nodes"), &DBusProxy::get_nodes);
+};
@@ -0,0 +1,74 @@
+#ifndef DBUS_PROXY_CLASS_H
+#define DBUS_PROXY_CLASS_H
+
+#include <memory>
+
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/variant/array.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/variant.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "dbus_introspection.h"
+#include "dbus_message.h"
+#include "dbus_pending_call.h"
+
+class DBus;
+
+// Typed handle to a remote object, created from its introspection data. Every
+// method and property carries its signature already compiled, so calls only
+// need the method name and arguments and are not validated again. Methods are
+// looked up in every interface of the object unless an interface is given.
+class DBusProxy : public godot::RefCounted {
+  GDCLASS(DBusProxy, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  const DBusIntrospectedInterface *find_interface(const godot::String &iface);
+  const DBusIntrospectedMethod *
+  resolve_method(const godot::String &method, const godot::String &iface,
+                 const DBusIntrospectedInterface *&found);
+  const DBusIntrospectedProperty *
+  resolve_property(const godot::String &name, const godot::String &iface,
+                   const DBusIntrospectedInterface *&found);
+  ::DBusMessage *build_call(const godot::String &method,
+                            const godot::Array &args,
+                            const godot::String &iface);
+
+public:
+  // Constructor/deconstructor
+  DBusProxy();
+  ~DBusProxy();
+
+  // Properties
+  godot::Ref<DBus> dbus;
+  godot::String bus_name;
+  godot::String path;
+  std::shared_ptr<const DBusIntrospection> introspection;
+
+  // Methods
+  DBusMessage *call_method(godot::String method, godot::Array args,
+                           godot::String iface);
+  DBusPendingCall *call_method_async(godot::String method, godot::Array args,
+                                     godot::String iface, int timeout_ms);
+  godot::Variant get_property(godot::String name, godot::String iface);
+  int set_property(godot::String name, godot::Variant value,
+                   godot::String iface);
+  godot::String get_bus_name();
+  godot::String get_path();
+  godot::PackedStringArray get_interfaces();
+  godot::Dictionary get_methods(godot::String iface);
+  godot::Dictionary get_properties(godot::String iface);
+  godot::PackedStringArray get_signals(godot::String iface);
+  godot::PackedStringArray get_nodes();
+};
+
+#endif // DBUS_PROXY_CLASS_H
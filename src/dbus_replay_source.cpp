@@ -0,0 +1,179 @@
+#include "dbus_replay_source.h"
+
+#include <cstring>
+
+#include "dbus_capture.h"
+#include "godot_cpp/classes/time.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::FileAccess;
+using godot::PackedByteArray;
+using godot::String;
+
+// Message data slot marking messages that were replayed
+static dbus_int32_t replay_slot = -1;
+
+DBusReplaySource::DBusReplaySource() {
+  // The slot is allocated once and shared by every replay source
+  if (replay_slot < 0) {
+    ::dbus_message_allocate_data_slot(&replay_slot);
+  }
+};
+DBusReplaySource::~DBusReplaySource(){};
+
+// Opens the given capture file and rewinds to its first message
+int DBusReplaySource::open(String path) {
+  close();
+  file = FileAccess::open(path, FileAccess::READ);
+  if (file.is_null()) {
+    godot::UtilityFunctions::push_error("Unable to open capture file: ", path);
+    return FileAccess::get_open_error();
+  }
+
+  // Check the header
+  PackedByteArray magic = file->get_buffer(DBUS_CAPTURE_MAGIC_LENGTH);
+  if (magic.size() != DBUS_CAPTURE_MAGIC_LENGTH ||
+      memcmp(magic.ptr(), DBUS_CAPTURE_MAGIC, DBUS_CAPTURE_MAGIC_LENGTH) != 0) {
+    godot::UtilityFunctions::push_error("Not a capture file: ", path);
+    close();
+    return godot::ERR_FILE_UNRECOGNIZED;
+  }
+  uint32_t version = file->get_32();
+  if (version != DBUS_CAPTURE_VERSION) {
+    godot::UtilityFunctions::push_error("Unsupported capture file version: ",
+                                        version);
+    close();
+    return godot::ERR_FILE_UNRECOGNIZED;
+  }
+
+  data_start = file->get_position();
+  rewind();
+  return godot::OK;
+}
+
+// Closes the capture file
+void DBusReplaySource::close() {
+  if (file.is_valid()) {
+    file->close();
+    file.unref();
+  }
+  has_record = false;
+  record = PackedByteArray();
+  finished = true;
+}
+
+// Starts replaying from the first message again. The recorded timing is
+// measured from the next time a message is taken.
+void DBusReplaySource::rewind() {
+  if (file.is_null()) {
+    return;
+  }
+  file->seek(data_start);
+  has_record = false;
+  start_ticks = 0;
+  replayed = 0;
+  finished = false;
+}
+
+// Reads the next record from the capture file. Returns false at the end of
+// the file or if the record is truncated.
+bool DBusReplaySource::read_record() {
+  if (file->get_position() + 12 > file->get_length()) {
+    return false;
+  }
+  record_usec = file->get_64();
+  uint32_t size = file->get_32();
+  if (size > DBUS_MAXIMUM_MESSAGE_LENGTH) {
+    godot::UtilityFunctions::push_warning("Corrupt capture file record");
+    return false;
+  }
+  record = file->get_buffer(size);
+  return record.size() == (int64_t)size;
+}
+
+// Returns the next recorded message if it is due, or nullptr if there is none
+// yet. At a speed of zero messages are always due. The caller takes ownership
+// of the message.
+::DBusMessage *DBusReplaySource::take_message() {
+  while (!finished) {
+    if (!has_record && !(has_record = read_record())) {
+      if (looping && replayed > 0) {
+        rewind();
+        continue;
+      }
+      finished = true;
+      return nullptr;
+    }
+
+    // Wait until the message is due
+    uint64_t now = godot::Time::get_singleton()->get_ticks_usec();
+    if (start_ticks == 0) {
+      start_ticks = now - (speed > 0.0 ? (uint64_t)(record_usec / speed) : 0);
+    }
+    if (speed > 0.0 && now < start_ticks + (uint64_t)(record_usec / speed)) {
+      return nullptr;
+    }
+
+    has_record = false;
+    DBusError dbus_error;
+    ::dbus_error_init(&dbus_error);
+    ::DBusMessage *msg = ::dbus_message_demarshal(
+        (const char *)record.ptr(), record.size(), &dbus_error);
+    if (msg == nullptr) {
+      godot::UtilityFunctions::push_warning(
+          "Unable to decode captured message: ", dbus_error.message);
+      ::dbus_error_free(&dbus_error);
+      continue;
+    }
+    ::dbus_message_set_data(msg, replay_slot, &replay_slot, nullptr);
+    replayed++;
+    return msg;
+  }
+  return nullptr;
+}
+
+// Returns true if the given message was taken from a replay source rather
+// than received from a connection
+bool DBusReplaySource::is_replayed(::DBusMessage *msg) {
+  return replay_slot >= 0 &&
+         ::dbus_message_get_data(msg, replay_slot) != nullptr;
+}
+
+// Sets the replay speed relative to the recorded timing. A speed of zero
+// replays the messages as fast as they are taken.
+void DBusReplaySource::set_speed(double value) {
+  speed = value < 0.0 ? 0.0 : value;
+  start_ticks = 0;
+}
+
+// Returns the replay speed
+double DBusReplaySource::get_speed() { return speed; }
+
+// Sets whether to start over once the last message has been replayed
+void DBusReplaySource::set_looping(bool enabled) { looping = enabled; }
+
+// Returns whether replay starts over after the last message
+bool DBusReplaySource::is_looping() { return looping; }
+
+// Returns whether all messages have been replayed
+bool DBusReplaySource::is_finished() { return finished; }
+
+// Returns the number of messages replayed since the last rewind
+int DBusReplaySource::get_replayed_count() { return replayed; }
+
+// Register the methods with Godot
+void DBusReplaySource::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("open", "path"), &DBusReplaySource::open);
+  ClassDB::bind_method(D_METHOD("close"), &DBusReplaySource::close);
+  ClassDB::bind_method(D_METHOD("rewind"), &DBusReplaySource::rewind);
+  ClassDB::bind_method(D_METHOD("set_speed", "speed"),
+                       &DBusReplaySource::set_speed);
+  ClassDB::bind_method(D_METHOD("get_speed"), &DBusReplaySource::get_speed);
+  ClassDB::bind_method(D_METHOD("set_looping", "enabled"),
+                       &DBusReplaySource::set_looping);
+  ClassDB::bind_method(D_METHOD("is_looping"), &DBusReplaySource::is_looping);
+  ClassDB::bind_method(D_METHOD("is_finished"), &DBusReplaySource::is_finished);
+  ClassDB::bind_method(D_METHOD("get_replayed_count"),
+                       &DBusReplaySource::get_replayed_count);
+};
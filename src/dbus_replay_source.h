@@ -0,0 +1,67 @@
+#ifndef DBUS_REPLAY_SOURCE_CLASS_H
+#define DBUS_REPLAY_SOURCE_CLASS_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+
+#include "godot_cpp/classes/file_access.hpp"
+#include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+// Feeds the messages of a capture file written by DBus.start_capture back into
+// a DBus object as if they had been received from the bus. They go through the
+// same pop_message/dispatch path as live traffic, either with their recorded
+// timing or as fast as they are consumed. Only replayed signals are routed to
+// subscriptions. Replayed method calls and replies are never handed to
+// exported objects or pending calls, so they cannot complete live calls or
+// put replies on the bus.
+class DBusReplaySource : public godot::RefCounted {
+  GDCLASS(DBusReplaySource, godot::RefCounted);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::Ref<godot::FileAccess> file;
+  uint64_t data_start = 0;
+  double speed = 1.0;
+  bool looping = false;
+  bool finished = true;
+  uint64_t replayed = 0;
+
+  // Next record, read ahead so its timestamp can be checked
+  bool has_record = false;
+  uint64_t record_usec = 0;
+  godot::PackedByteArray record;
+
+  // Ticks when replay started, or zero if it has not started yet
+  uint64_t start_ticks = 0;
+
+  bool read_record();
+
+public:
+  // Constructor/deconstructor
+  DBusReplaySource();
+  ~DBusReplaySource();
+
+  // Methods
+  ::DBusMessage *take_message();
+  static bool is_replayed(::DBusMessage *msg);
+  int open(godot::String path);
+  void close();
+  void rewind();
+  void set_speed(double value);
+  double get_speed();
+  void set_looping(bool enabled);
+  bool is_looping();
+  bool is_finished();
+  int get_replayed_count();
+};
+
+#endif // DBUS_REPLAY_SOURCE_CLASS_H
@@ -0,0 +1,268 @@
+#include "dbus_signal_table.h"
+
+#include <cstring>
+
+using godot::Callable;
+using godot::String;
+using godot::StringName;
+using godot::Vector;
+
+// Wildcard bits used to index wildcard_counts
+static const int WILDCARD_IFACE = 1 << 0;
+static const int WILDCARD_MEMBER = 1 << 1;
+static const int WILDCARD_PATH = 1 << 2;
+
+// Returns which fields of the given key are wildcards
+int DBusSignalTable::get_wildcard_mask(const DBusSignalKey &key) {
+  int mask = 0;
+  if (key.iface.is_empty()) {
+    mask |= WILDCARD_IFACE;
+  }
+  if (key.member.is_empty()) {
+    mask |= WILDCARD_MEMBER;
+  }
+  if (key.path.is_empty()) {
+    mask |= WILDCARD_PATH;
+  }
+  return mask;
+}
+
+// Returns the first argument of the given message if it is a string
+static String read_arg0(::DBusMessage *msg) {
+  DBusMessageIter iter;
+  if (!::dbus_message_iter_init(msg, &iter) ||
+      ::dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING) {
+    return String();
+  }
+  const char *value = nullptr;
+  ::dbus_message_iter_get_basic(&iter, &value);
+  return String::utf8(value);
+}
+
+// Returns true if a signal from "sender" matches a subscription to the given
+// sender name
+bool DBusSignalTable::sender_matches(const String &name, const char *sender,
+                                     bool check_owners) {
+  // Peers do not set a sender
+  if (sender == nullptr) {
+    return true;
+  }
+  if (!name.begins_with(":")) {
+    if (!check_owners) {
+      return true;
+    }
+    const DBusNameOwner *entry = owners.getptr(name);
+    if (entry != nullptr) {
+      return !entry->owner.is_empty() && entry->owner == String::utf8(sender);
+    }
+  }
+  return name == String::utf8(sender);
+}
+
+// Adds a subscription and returns its id
+int DBusSignalTable::add(String sender, String path, String iface,
+                         String member, String arg0, Callable callable,
+                         String rule) {
+  DBusSignalKey key;
+  key.iface = StringName(iface);
+  key.member = StringName(member);
+  key.path = StringName(path);
+
+  DBusSubscription subscription;
+  subscription.id = next_id++;
+  subscription.sender = sender;
+  subscription.arg0 = arg0;
+  subscription.rule = rule;
+  subscription.callable = callable;
+
+  if (!entries.has(key)) {
+    entries.insert(key, Vector<DBusSubscription>());
+  }
+  entries[key].push_back(subscription);
+  keys_by_id.insert(subscription.id, key);
+  wildcard_counts[get_wildcard_mask(key)]++;
+
+  return subscription.id;
+}
+
+// Removes the subscription with the given id. The match rule and sender it
+// was added with are returned in "r_rule" and "r_sender".
+bool DBusSignalTable::remove(int id, String *r_rule, String *r_sender) {
+  if (!keys_by_id.has(id)) {
+    return false;
+  }
+  DBusSignalKey key = keys_by_id[id];
+  keys_by_id.erase(id);
+
+  Vector<DBusSubscription> &subscriptions = entries[key];
+  for (int i = 0; i < subscriptions.size(); i++) {
+    if (subscriptions[i].id != id) {
+      continue;
+    }
+    if (r_rule != nullptr) {
+      *r_rule = subscriptions[i].rule;
+    }
+    if (r_sender != nullptr) {
+      *r_sender = subscriptions[i].sender;
+    }
+    subscriptions.remove_at(i);
+    break;
+  }
+  if (subscriptions.is_empty()) {
+    entries.erase(key);
+  }
+  wildcard_counts[get_wildcard_mask(key)]--;
+
+  return true;
+}
+
+// Returns true if there are no subscriptions
+bool DBusSignalTable::is_empty() { return keys_by_id.is_empty(); }
+
+// Returns the match rules of all subscriptions and tracked owners
+Vector<String> DBusSignalTable::get_rules() {
+  Vector<String> rules;
+  for (const godot::KeyValue<String, DBusNameOwner> &entry : owners) {
+    rules.push_back(entry.value.rule);
+  }
+  for (const godot::KeyValue<DBusSignalKey, Vector<DBusSubscription>> &entry :
+       entries) {
+    for (int i = 0; i < entry.value.size(); i++) {
+      rules.push_back(entry.value[i].rule);
+    }
+  }
+  return rules;
+}
+
+// Removes all subscriptions
+void DBusSignalTable::clear() {
+  entries.clear();
+  keys_by_id.clear();
+  owners.clear();
+  for (int i = 0; i < 8; i++) {
+    wildcard_counts[i] = 0;
+  }
+}
+
+// Adds a reference to the owner of the given well-known name if it is already
+// tracked. Returns false if it is not, in which case the caller resolves the
+// owner and adds it with add_owner.
+bool DBusSignalTable::ref_owner(const String &name) {
+  DBusNameOwner *entry = owners.getptr(name);
+  if (entry == nullptr) {
+    return false;
+  }
+  entry->refcount++;
+  return true;
+}
+
+// Starts tracking the owner of the given well-known name
+void DBusSignalTable::add_owner(const String &name, const String &owner,
+                                const String &rule) {
+  DBusNameOwner entry;
+  entry.owner = owner;
+  entry.rule = rule;
+  entry.refcount = 1;
+  owners.insert(name, entry);
+}
+
+// Drops a reference to the owner of the given well-known name. Returns true
+// once it is no longer tracked, with the match rule to remove in "r_rule".
+bool DBusSignalTable::unref_owner(const String &name, String *r_rule) {
+  DBusNameOwner *entry = owners.getptr(name);
+  if (entry == nullptr || --entry->refcount > 0) {
+    return false;
+  }
+  if (r_rule != nullptr) {
+    *r_rule = entry->rule;
+  }
+  owners.erase(name);
+  return true;
+}
+
+// Applies a NameOwnerChanged signal from the bus to the tracked owners.
+// Returns true if the signal was for a tracked name.
+bool DBusSignalTable::update_owner(::DBusMessage *msg) {
+  if (owners.is_empty() ||
+      !::dbus_message_is_signal(msg, DBUS_INTERFACE_DBUS, "NameOwnerChanged")) {
+    return false;
+  }
+  // Only the bus itself may announce owner changes. It sends its signals
+  // with its well-known name as the sender.
+  const char *sender = ::dbus_message_get_sender(msg);
+  if (sender == nullptr || strcmp(sender, DBUS_SERVICE_DBUS) != 0) {
+    return false;
+  }
+
+  const char *name = nullptr;
+  const char *old_owner = nullptr;
+  const char *new_owner = nullptr;
+  if (!::dbus_message_get_args(msg, nullptr, DBUS_TYPE_STRING, &name,
+                               DBUS_TYPE_STRING, &old_owner, DBUS_TYPE_STRING,
+                               &new_owner, DBUS_TYPE_INVALID)) {
+    return false;
+  }
+  DBusNameOwner *entry = owners.getptr(String::utf8(name));
+  if (entry == nullptr) {
+    return false;
+  }
+  entry->owner = String::utf8(new_owner);
+  return true;
+}
+
+// Appends the callables of every subscription matching the given signal to
+// "r_callables". Subscriptions to a unique name or an untracked well-known
+// name (such as the bus itself) are checked against the sender header as is,
+// and subscriptions to a tracked well-known name against its current owner.
+// Without "check_owners" only unique names are checked, e.g. for replayed
+// signals whose senders are long gone.
+void DBusSignalTable::match(::DBusMessage *msg, bool check_owners,
+                            Vector<Callable> &r_callables) {
+  if (entries.is_empty()) {
+    return;
+  }
+
+  const char *iface = ::dbus_message_get_interface(msg);
+  const char *member = ::dbus_message_get_member(msg);
+  const char *path = ::dbus_message_get_path(msg);
+  const char *sender = ::dbus_message_get_sender(msg);
+  StringName iface_name = iface != nullptr ? StringName(iface) : StringName();
+  StringName member_name =
+      member != nullptr ? StringName(member) : StringName();
+  StringName path_name = path != nullptr ? StringName(path) : StringName();
+  // First argument, only read once a subscription needs it
+  String arg0;
+  bool arg0_read = false;
+
+  for (int mask = 0; mask < 8; mask++) {
+    if (wildcard_counts[mask] == 0) {
+      continue;
+    }
+    DBusSignalKey key;
+    key.iface = (mask & WILDCARD_IFACE) ? StringName() : iface_name;
+    key.member = (mask & WILDCARD_MEMBER) ? StringName() : member_name;
+    key.path = (mask & WILDCARD_PATH) ? StringName() : path_name;
+
+    const Vector<DBusSubscription> *subscriptions = entries.getptr(key);
+    if (subscriptions == nullptr) {
+      continue;
+    }
+    for (int i = 0; i < subscriptions->size(); i++) {
+      const DBusSubscription &subscription = (*subscriptions)[i];
+      if (!subscription.sender.is_empty() &&
+          !sender_matches(subscription.sender, sender, check_owners)) {
+        continue;
+      }
+      if (!subscription.arg0.is_empty()) {
+        if (!arg0_read) {
+          arg0 = read_arg0(msg);
+          arg0_read = true;
+        }
+        if (subscription.arg0 != arg0) {
+          continue;
+        }
+      }
+      r_callables.push_back(subscription.callable);
+    }
+  }
+}
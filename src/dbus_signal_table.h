@@ -0,0 +1,94 @@
+#ifndef DBUS_SIGNAL_TABLE_H
+#define DBUS_SIGNAL_TABLE_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/templates/hashfuncs.hpp"
+#include "godot_cpp/templates/vector.hpp"
+#include "godot_cpp/variant/callable.hpp"
+#include "godot_cpp/variant/string.hpp"
+#include "godot_cpp/variant/string_name.hpp"
+
+// Key used to look up signal subscriptions. Fields are interned so that
+// comparisons are pointer compares. Empty fields act as wildcards.
+struct DBusSignalKey {
+  godot::StringName iface;
+  godot::StringName member;
+  godot::StringName path;
+
+  bool operator==(const DBusSignalKey &other) const {
+    return iface == other.iface && member == other.member &&
+           path == other.path;
+  }
+};
+
+struct DBusSignalKeyHasher {
+  static uint32_t hash(const DBusSignalKey &key) {
+    uint32_t h = godot::hash_murmur3_one_32(key.iface.hash());
+    h = godot::hash_murmur3_one_32(key.member.hash(), h);
+    h = godot::hash_murmur3_one_32(key.path.hash(), h);
+    return godot::hash_fmix32(h);
+  }
+};
+
+// A single subscription to a signal
+struct DBusSubscription {
+  int id = 0;
+  godot::String sender;
+  // Required value of the first argument if not empty, for signals like
+  // NameOwnerChanged that are only interesting for a single name
+  godot::String arg0;
+  godot::String rule;
+  godot::Callable callable;
+};
+
+// Current owner of a well-known bus name used as a subscription's sender.
+// Signals carry the unique name of their sender, so subscriptions to a
+// well-known name are matched against its tracked owner.
+struct DBusNameOwner {
+  // Unique name of the owner, or empty if the name has no owner
+  godot::String owner;
+  // Match rule for the NameOwnerChanged signal of the name
+  godot::String rule;
+  int refcount = 0;
+};
+
+// Table of signal subscriptions keyed by (interface, member, path). Lookups
+// for wildcard subscriptions are only done for the wildcard combinations that
+// are actually in use.
+class DBusSignalTable {
+private:
+  godot::HashMap<DBusSignalKey, godot::Vector<DBusSubscription>,
+                 DBusSignalKeyHasher>
+      entries;
+  godot::HashMap<int, DBusSignalKey> keys_by_id;
+  godot::HashMap<godot::String, DBusNameOwner> owners;
+  int wildcard_counts[8] = {};
+  int next_id = 1;
+
+  static int get_wildcard_mask(const DBusSignalKey &key);
+  bool sender_matches(const godot::String &name, const char *sender,
+                      bool check_owners);
+
+public:
+  int add(godot::String sender, godot::String path, godot::String iface,
+          godot::String member, godot::String arg0, godot::Callable callable,
+          godot::String rule);
+  bool remove(int id, godot::String *r_rule, godot::String *r_sender);
+  bool is_empty();
+  godot::Vector<godot::String> get_rules();
+  void clear();
+  void match(::DBusMessage *msg, bool check_owners,
+             godot::Vector<godot::Callable> &r_callables);
+
+  // Owner tracking of well-known sender names
+  bool ref_owner(const godot::String &name);
+  void add_owner(const godot::String &name, const godot::String &owner,
+                 const godot::String &rule);
+  bool unref_owner(const godot::String &name, godot::String *r_rule);
+  bool update_owner(::DBusMessage *msg);
+};
+
+#endif // DBUS_SIGNAL_TABLE_H
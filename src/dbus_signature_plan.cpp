@@ -0,0 +1,157 @@
+#include "dbus_signature_plan.h"
+#include "dbus/dbus-protocol.h"
+
+#include "godot_cpp/core/memory.hpp"
+#include "godot_cpp/templates/hash_map.hpp"
+#include "godot_cpp/variant/utility_functions.hpp"
+
+using godot::String;
+
+// Maximum number of compiled signatures to keep around
+static const int PLAN_CACHE_SIZE = 128;
+
+struct DBusSignaturePlanCacheEntry {
+  std::shared_ptr<const DBusSignaturePlan> plan;
+  uint64_t last_used = 0;
+};
+
+typedef godot::HashMap<String, DBusSignaturePlanCacheEntry>
+    DBusSignaturePlanCache;
+
+// Cache of compiled signatures. Only used from the main thread. Allocated on
+// first use and freed with clear_cache when the extension is unloaded.
+static DBusSignaturePlanCache *plan_cache = nullptr;
+static uint64_t plan_cache_clock = 0;
+
+// Compiles the complete type at the cursor and appends its ops. Returns the
+// index of the op for the type.
+int DBusSignaturePlan::compile_type(const char *&cursor) {
+  int index = ops.size();
+  ops.push_back(DBusSignatureOp());
+  char code = *cursor++;
+
+  int type = code;
+  int element_type = DBUS_TYPE_INVALID;
+  std::string element_signature;
+  switch (code) {
+  case DBUS_TYPE_ARRAY: {
+    const char *element_start = cursor;
+    element_type = *cursor == DBUS_DICT_ENTRY_BEGIN_CHAR ? DBUS_TYPE_DICT_ENTRY
+                                                         : *cursor;
+    compile_type(cursor);
+    element_signature = std::string(element_start, cursor - element_start);
+    break;
+  }
+  case DBUS_STRUCT_BEGIN_CHAR:
+    type = DBUS_TYPE_STRUCT;
+    while (*cursor != DBUS_STRUCT_END_CHAR) {
+      compile_type(cursor);
+    }
+    cursor++;
+    break;
+  case DBUS_DICT_ENTRY_BEGIN_CHAR:
+    type = DBUS_TYPE_DICT_ENTRY;
+    while (*cursor != DBUS_DICT_ENTRY_END_CHAR) {
+      compile_type(cursor);
+    }
+    cursor++;
+    break;
+  default:
+    break;
+  }
+
+  // Children may have reallocated the list, so only write the op now
+  DBusSignatureOp &op = ops[index];
+  op.type = type;
+  op.element_type = element_type;
+  op.element_signature = element_signature;
+  op.next = ops.size();
+
+  return index;
+}
+
+// Compiles the given signature without going through the cache
+std::shared_ptr<const DBusSignaturePlan>
+DBusSignaturePlan::compile(const char *signature) {
+  DBusError dbus_error;
+  ::dbus_error_init(&dbus_error);
+
+  // Validate the passed signature
+  if (!::dbus_signature_validate(signature, &dbus_error)) {
+    godot::UtilityFunctions::push_warning(
+        "Invalid signature passed: ", dbus_error.name, " ", dbus_error.message);
+    ::dbus_error_free(&dbus_error);
+    return nullptr;
+  }
+
+  std::shared_ptr<DBusSignaturePlan> plan =
+      std::make_shared<DBusSignaturePlan>();
+  plan->signature = signature;
+  const char *cursor = signature;
+  while (*cursor != DBUS_TYPE_INVALID) {
+    plan->compile_type(cursor);
+  }
+
+  return plan;
+}
+
+// Returns the plan for the given signature from the cache, compiling it if
+// needed. When the cache is full, the least recently used plan is evicted.
+std::shared_ptr<const DBusSignaturePlan>
+DBusSignaturePlan::get(const String &signature) {
+  if (plan_cache == nullptr) {
+    plan_cache = memnew(DBusSignaturePlanCache);
+  }
+  plan_cache_clock++;
+
+  DBusSignaturePlanCacheEntry *entry = plan_cache->getptr(signature);
+  if (entry != nullptr) {
+    entry->last_used = plan_cache_clock;
+    return entry->plan;
+  }
+
+  std::shared_ptr<const DBusSignaturePlan> plan =
+      compile(signature.utf8().get_data());
+  if (plan == nullptr) {
+    return nullptr;
+  }
+
+  // Evict the least recently used plan
+  if ((int)plan_cache->size() >= PLAN_CACHE_SIZE) {
+    String oldest;
+    uint64_t oldest_used = UINT64_MAX;
+    for (const godot::KeyValue<String, DBusSignaturePlanCacheEntry> &cached :
+         *plan_cache) {
+      if (cached.value.last_used < oldest_used) {
+        oldest = cached.key;
+        oldest_used = cached.value.last_used;
+      }
+    }
+    plan_cache->erase(oldest);
+  }
+
+  DBusSignaturePlanCacheEntry new_entry;
+  new_entry.plan = plan;
+  new_entry.last_used = plan_cache_clock;
+  plan_cache->insert(signature, new_entry);
+
+  return plan;
+}
+
+// Frees all cached plans
+void DBusSignaturePlan::clear_cache() {
+  if (plan_cache == nullptr) {
+    return;
+  }
+  memdelete(plan_cache);
+  plan_cache = nullptr;
+}
+
+// Returns the number of complete types at the top level of the signature
+int DBusSignaturePlan::get_arg_count() const {
+  int count = 0;
+  for (size_t op = 0; op < ops.size(); op = ops[op].next) {
+    count++;
+  }
+  return count;
+}
@@ -0,0 +1,50 @@
+#ifndef DBUS_SIGNATURE_PLAN_H
+#define DBUS_SIGNATURE_PLAN_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "godot_cpp/variant/string.hpp"
+
+// A single complete type in a compiled signature
+struct DBusSignatureOp {
+  // D-Bus type code, e.g. DBUS_TYPE_STRING or DBUS_TYPE_ARRAY
+  int type = DBUS_TYPE_INVALID;
+  // For arrays, the type code of the elements (DBUS_TYPE_DICT_ENTRY for
+  // dictionaries)
+  int element_type = DBUS_TYPE_INVALID;
+  // Index of the op following this type and everything it contains. The
+  // children of a container always directly follow the container.
+  int next = 0;
+  // For arrays, the signature of a single element as needed to open the
+  // container
+  std::string element_signature;
+};
+
+// A signature compiled once into a flat list of ops laid out in pre-order, so
+// that marshaling arguments is a walk over the list instead of re-parsing and
+// re-validating the signature for every message.
+class DBusSignaturePlan {
+private:
+  int compile_type(const char *&cursor);
+
+public:
+  std::string signature;
+  std::vector<DBusSignatureOp> ops;
+
+  // Returns the plan for the given signature from the cache, compiling it if
+  // needed. Returns nullptr if the signature is invalid.
+  static std::shared_ptr<const DBusSignaturePlan>
+  get(const godot::String &signature);
+  static std::shared_ptr<const DBusSignaturePlan>
+  compile(const char *signature);
+  static void clear_cache();
+
+  // Returns the number of complete types at the top level of the signature
+  int get_arg_count() const;
+};
+
+#endif // DBUS_SIGNATURE_PLAN_H
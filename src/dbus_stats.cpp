@@ -0,0 +1,102 @@
+#include "dbus_stats.h"
+
+#include <dbus/dbus.h>
+
+#include "godot_cpp/variant/packed_int64_array.hpp"
+
+using godot::Dictionary;
+
+// Adds a value to the histogram
+void DBusHistogram::add(uint64_t value) {
+  count++;
+  total += value;
+  last = value;
+  if (value > max) {
+    max = value;
+  }
+  int bucket = 0;
+  while (bucket < BUCKET_COUNT - 1 && value >= ((uint64_t)1 << bucket)) {
+    bucket++;
+  }
+  buckets[bucket]++;
+}
+
+// Returns the upper bound of the bucket holding the given percentile
+uint64_t DBusHistogram::get_percentile(double pct) const {
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t target = (uint64_t)(count * pct / 100.0);
+  uint64_t seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; i++) {
+    seen += buckets[i];
+    if (seen > target) {
+      uint64_t bound = (uint64_t)1 << i;
+      return bound < max ? bound : max;
+    }
+  }
+  return max;
+}
+
+// Returns the histogram as a dictionary
+Dictionary DBusHistogram::to_dictionary() const {
+  Dictionary result = Dictionary();
+  result["count"] = count;
+  result["total"] = total;
+  result["max"] = max;
+  result["last"] = last;
+  result["mean"] = count == 0 ? 0.0 : (double)total / (double)count;
+  result["p50"] = get_percentile(50);
+  result["p99"] = get_percentile(99);
+  godot::PackedInt64Array counts = godot::PackedInt64Array();
+  counts.resize(BUCKET_COUNT);
+  for (int i = 0; i < BUCKET_COUNT; i++) {
+    counts.ptrw()[i] = buckets[i];
+  }
+  result["buckets"] = counts;
+  return result;
+}
+
+// Counts a message sent or received on the connection
+void DBusStats::count_message(::DBusMessage *msg, bool outgoing) {
+  if (outgoing) {
+    messages_out++;
+  } else {
+    messages_in++;
+    if (::dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_SIGNAL) {
+      signals_in++;
+    }
+  }
+  if (!count_bytes) {
+    return;
+  }
+
+  char *data = nullptr;
+  int size = 0;
+  if (!::dbus_message_marshal(msg, &data, &size)) {
+    return;
+  }
+  ::dbus_free(data);
+  if (outgoing) {
+    bytes_out += size;
+  } else {
+    bytes_in += size;
+  }
+}
+
+// Returns all statistics as a dictionary
+Dictionary DBusStats::to_dictionary() const {
+  Dictionary result = Dictionary();
+  result["messages_in"] = messages_in;
+  result["messages_out"] = messages_out;
+  result["bytes_in"] = bytes_in;
+  result["bytes_out"] = bytes_out;
+  result["signals_in"] = signals_in;
+  result["signals_dropped"] = signals_dropped;
+  result["messages_dropped"] = messages_dropped;
+  result["read_write_usec"] = read_write_usec.to_dictionary();
+  result["decode_usec"] = decode_usec.to_dictionary();
+  result["blocking_usec"] = blocking_usec.to_dictionary();
+  result["queue_depth"] = queue_depth.to_dictionary();
+  return result;
+}
@@ -0,0 +1,50 @@
+#ifndef DBUS_STATS_H
+#define DBUS_STATS_H
+
+#include <cstdint>
+#include <dbus/dbus.h>
+
+#include "godot_cpp/variant/dictionary.hpp"
+
+// Histogram of values with power of two buckets. Bucket "i" counts values
+// below 2^i, starting from the previous bucket's bound.
+struct DBusHistogram {
+  static const int BUCKET_COUNT = 24;
+
+  uint64_t count = 0;
+  uint64_t total = 0;
+  uint64_t max = 0;
+  uint64_t last = 0;
+  uint64_t buckets[BUCKET_COUNT] = {};
+
+  void add(uint64_t value);
+  uint64_t get_percentile(double pct) const;
+  godot::Dictionary to_dictionary() const;
+};
+
+// Runtime statistics of a single connection. Only allocated while stats are
+// enabled, so every hook is a single null check when they are not.
+struct DBusStats {
+  uint64_t messages_in = 0;
+  uint64_t messages_out = 0;
+  uint64_t bytes_in = 0;
+  uint64_t bytes_out = 0;
+  uint64_t signals_in = 0;
+  uint64_t signals_dropped = 0;
+  uint64_t messages_dropped = 0;
+  // Whether message sizes are counted. Getting the size of a message means
+  // serializing it, so this is opt-in.
+  bool count_bytes = false;
+
+  // Time in microseconds
+  DBusHistogram read_write_usec;
+  DBusHistogram decode_usec;
+  DBusHistogram blocking_usec;
+  // Messages waiting in the I/O thread's queue when it is drained
+  DBusHistogram queue_depth;
+
+  void count_message(::DBusMessage *msg, bool outgoing);
+  godot::Dictionary to_dictionary() const;
+};
+
+#endif // DBUS_STATS_H
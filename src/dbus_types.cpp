@@ -1,13 +1,124 @@
 #include "dbus_types.h"
 
+using godot::Array;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::String;
+using godot::Variant;
+
 // Base
 DBusType::DBusType(){};
 DBusType::~DBusType(){};
-void DBusType::_bind_methods(){};
+int DBusType::get_type_code() { return type_code; };
+Variant DBusType::to_variant() { return Variant(); };
+void DBusType::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("get_type_code"), &DBusType::get_type_code);
+  ClassDB::bind_method(D_METHOD("to_variant"), &DBusType::to_variant);
+};
 
 // UInt32
-DBusUInt32::DBusUInt32(){};
+DBusUInt32::DBusUInt32() { type_code = DBUS_TYPE_UINT32; };
 DBusUInt32::~DBusUInt32(){};
 void DBusUInt32::set_value(uint32_t v) { value = v; };
 uint32_t DBusUInt32::get_value() { return value; };
-void DBusUInt32::_bind_methods(){};
+Variant DBusUInt32::to_variant() { return Variant((int64_t)value); };
+void DBusUInt32::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"), &DBusUInt32::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusUInt32::get_value);
+};
+
+// Int16
+DBusInt16::DBusInt16() { type_code = DBUS_TYPE_INT16; };
+DBusInt16::~DBusInt16(){};
+void DBusInt16::set_value(int16_t v) { value = v; };
+int16_t DBusInt16::get_value() { return value; };
+Variant DBusInt16::to_variant() { return Variant((int64_t)value); };
+void DBusInt16::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"), &DBusInt16::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusInt16::get_value);
+};
+
+// UInt16
+DBusUInt16::DBusUInt16() { type_code = DBUS_TYPE_UINT16; };
+DBusUInt16::~DBusUInt16(){};
+void DBusUInt16::set_value(uint16_t v) { value = v; };
+uint16_t DBusUInt16::get_value() { return value; };
+Variant DBusUInt16::to_variant() { return Variant((int64_t)value); };
+void DBusUInt16::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"), &DBusUInt16::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusUInt16::get_value);
+};
+
+// Int64
+DBusInt64::DBusInt64() { type_code = DBUS_TYPE_INT64; };
+DBusInt64::~DBusInt64(){};
+void DBusInt64::set_value(int64_t v) { value = v; };
+int64_t DBusInt64::get_value() { return value; };
+Variant DBusInt64::to_variant() { return Variant(value); };
+void DBusInt64::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"), &DBusInt64::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusInt64::get_value);
+};
+
+// UInt64
+DBusUInt64::DBusUInt64() { type_code = DBUS_TYPE_UINT64; };
+DBusUInt64::~DBusUInt64(){};
+void DBusUInt64::set_value(int64_t v) { value = (uint64_t)v; };
+int64_t DBusUInt64::get_value() { return (int64_t)value; };
+Variant DBusUInt64::to_variant() { return Variant((int64_t)value); };
+void DBusUInt64::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"), &DBusUInt64::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusUInt64::get_value);
+};
+
+// Byte
+DBusByte::DBusByte() { type_code = DBUS_TYPE_BYTE; };
+DBusByte::~DBusByte(){};
+void DBusByte::set_value(uint8_t v) { value = v; };
+uint8_t DBusByte::get_value() { return value; };
+Variant DBusByte::to_variant() { return Variant((int64_t)value); };
+void DBusByte::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"), &DBusByte::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusByte::get_value);
+};
+
+// Object path
+DBusObjectPath::DBusObjectPath() { type_code = DBUS_TYPE_OBJECT_PATH; };
+DBusObjectPath::~DBusObjectPath(){};
+void DBusObjectPath::set_value(String v) { value = v; };
+String DBusObjectPath::get_value() { return value; };
+Variant DBusObjectPath::to_variant() { return Variant(value); };
+void DBusObjectPath::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"),
+                       &DBusObjectPath::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusObjectPath::get_value);
+};
+
+// Signature
+DBusSignature::DBusSignature() { type_code = DBUS_TYPE_SIGNATURE; };
+DBusSignature::~DBusSignature(){};
+void DBusSignature::set_value(String v) { value = v; };
+String DBusSignature::get_value() { return value; };
+Variant DBusSignature::to_variant() { return Variant(value); };
+void DBusSignature::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_value", "value"),
+                       &DBusSignature::set_value);
+  ClassDB::bind_method(D_METHOD("get_value"), &DBusSignature::get_value);
+};
+
+// Struct
+DBusStruct::DBusStruct() { type_code = DBUS_TYPE_STRUCT; };
+DBusStruct::~DBusStruct(){};
+void DBusStruct::set_signature(String v) { signature = v; };
+String DBusStruct::get_signature() { return signature; };
+void DBusStruct::set_fields(Array v) { fields = v; };
+Array DBusStruct::get_fields() { return fields; };
+Variant DBusStruct::to_variant() { return Variant(fields); };
+void DBusStruct::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_signature", "signature"),
+                       &DBusStruct::set_signature);
+  ClassDB::bind_method(D_METHOD("get_signature"), &DBusStruct::get_signature);
+  ClassDB::bind_method(D_METHOD("set_fields", "fields"),
+                       &DBusStruct::set_fields);
+  ClassDB::bind_method(D_METHOD("get_fields"), &DBusStruct::get_fields);
+};
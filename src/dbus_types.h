@@ -2,28 +2,37 @@
 #define DBUS_TYPES_CLASS_H
 
 #include "godot_cpp/classes/global_constants.hpp"
+#include "godot_cpp/variant/array.hpp"
 #include "godot_cpp/variant/dictionary.hpp"
 #include "godot_cpp/variant/packed_byte_array.hpp"
 #include "godot_cpp/variant/packed_string_array.hpp"
 #include "godot_cpp/variant/string.hpp"
 #include "godot_cpp/variant/variant.hpp"
 #include <cstdint>
+#include <dbus/dbus.h>
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/core/binder_common.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
-// Base class for DBusTypes
+// Base class for DBusTypes. Every wrapper carries the D-Bus type code it
+// should be marshaled as, so the marshaler can switch on the tag instead of
+// comparing class names.
 class DBusType : public godot::RefCounted {
   GDCLASS(DBusType, godot::RefCounted);
 
 protected:
   static void _bind_methods();
 
+  int type_code = DBUS_TYPE_INVALID;
+
 private:
 public:
   DBusType();
   ~DBusType();
+  int get_type_code();
+  // Returns the wrapped value as a plain Godot value
+  virtual godot::Variant to_variant();
 };
 
 // UInt32 wrapper
@@ -34,13 +43,163 @@ protected:
   static void _bind_methods();
 
 private:
-  uint32_t value;
+  uint32_t value = 0;
 
 public:
   DBusUInt32();
   ~DBusUInt32();
   void set_value(uint32_t v);
   uint32_t get_value();
+  godot::Variant to_variant() override;
+};
+
+// Int16 wrapper
+class DBusInt16 : public DBusType {
+  GDCLASS(DBusInt16, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  int16_t value = 0;
+
+public:
+  DBusInt16();
+  ~DBusInt16();
+  void set_value(int16_t v);
+  int16_t get_value();
+  godot::Variant to_variant() override;
+};
+
+// UInt16 wrapper
+class DBusUInt16 : public DBusType {
+  GDCLASS(DBusUInt16, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  uint16_t value = 0;
+
+public:
+  DBusUInt16();
+  ~DBusUInt16();
+  void set_value(uint16_t v);
+  uint16_t get_value();
+  godot::Variant to_variant() override;
+};
+
+// Int64 wrapper
+class DBusInt64 : public DBusType {
+  GDCLASS(DBusInt64, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  int64_t value = 0;
+
+public:
+  DBusInt64();
+  ~DBusInt64();
+  void set_value(int64_t v);
+  int64_t get_value();
+  godot::Variant to_variant() override;
+};
+
+// UInt64 wrapper. Godot integers are signed, so values above INT64_MAX are
+// passed in and out with the same bit pattern.
+class DBusUInt64 : public DBusType {
+  GDCLASS(DBusUInt64, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  uint64_t value = 0;
+
+public:
+  DBusUInt64();
+  ~DBusUInt64();
+  void set_value(int64_t v);
+  int64_t get_value();
+  godot::Variant to_variant() override;
+};
+
+// Byte wrapper
+class DBusByte : public DBusType {
+  GDCLASS(DBusByte, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  uint8_t value = 0;
+
+public:
+  DBusByte();
+  ~DBusByte();
+  void set_value(uint8_t v);
+  uint8_t get_value();
+  godot::Variant to_variant() override;
+};
+
+// Object path wrapper
+class DBusObjectPath : public DBusType {
+  GDCLASS(DBusObjectPath, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::String value;
+
+public:
+  DBusObjectPath();
+  ~DBusObjectPath();
+  void set_value(godot::String v);
+  godot::String get_value();
+  godot::Variant to_variant() override;
+};
+
+// Signature wrapper
+class DBusSignature : public DBusType {
+  GDCLASS(DBusSignature, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::String value;
+
+public:
+  DBusSignature();
+  ~DBusSignature();
+  void set_value(godot::String v);
+  godot::String get_value();
+  godot::Variant to_variant() override;
+};
+
+// Struct wrapper. Holds the fields in order along with the signature of the
+// whole struct, e.g. "(sv)", which is needed to box it in a variant.
+class DBusStruct : public DBusType {
+  GDCLASS(DBusStruct, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  godot::String signature;
+  godot::Array fields;
+
+public:
+  DBusStruct();
+  ~DBusStruct();
+  void set_signature(godot::String v);
+  godot::String get_signature();
+  void set_fields(godot::Array v);
+  godot::Array get_fields();
+  godot::Variant to_variant() override;
 };
 
 #endif // DBUS_TYPES_CLASS_H
@@ -0,0 +1,183 @@
+#include "dbus_unix_fd.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "godot_cpp/variant/utility_functions.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::PackedByteArray;
+using godot::Variant;
+
+DBusUnixFd::DBusUnixFd() { type_code = DBUS_TYPE_UNIX_FD; };
+DBusUnixFd::~DBusUnixFd() { close(); };
+
+// Takes ownership of the given descriptor, closing any previously held one
+void DBusUnixFd::set_fd(int new_fd) {
+  if (new_fd == fd) {
+    return;
+  }
+  close();
+  fd = new_fd;
+}
+
+// Returns the descriptor, which stays owned by this object
+int DBusUnixFd::get_fd() { return fd; }
+
+// Returns true if a descriptor is held
+bool DBusUnixFd::is_valid() { return fd >= 0; }
+
+// Releases ownership of the descriptor and returns it. The caller is then
+// responsible for closing it.
+int DBusUnixFd::detach() {
+  int detached = fd;
+  fd = -1;
+  return detached;
+}
+
+// Closes the descriptor if one is held
+void DBusUnixFd::close() {
+  if (fd < 0) {
+    return;
+  }
+  ::close(fd);
+  fd = -1;
+}
+
+// Returns the size in bytes of the file behind the descriptor, or -1 if it
+// cannot be determined
+int64_t DBusUnixFd::get_size() {
+  struct stat info;
+  if (fd < 0 || ::fstat(fd, &info) != 0) {
+    return -1;
+  }
+  return info.st_size;
+}
+
+// Returns the contents of the file behind the descriptor. Only files sealed
+// against shrinking and writing are mapped, since truncating a mapped file
+// makes reading it raise SIGBUS. Any other file comes from a peer that could
+// still change it, so it is read with pread up to its actual end instead.
+PackedByteArray DBusUnixFd::read_bytes() {
+  PackedByteArray bytes = PackedByteArray();
+  int64_t size = get_size();
+  if (size < 0) {
+    godot::UtilityFunctions::push_error("Unable to stat file descriptor: ",
+                                        strerror(errno));
+    return bytes;
+  }
+
+  int seals = ::fcntl(fd, F_GET_SEALS);
+  int required = F_SEAL_SHRINK | F_SEAL_WRITE;
+  if (seals < 0 || (seals & required) != required) {
+    return read_bytes_unsealed(size);
+  }
+  if (size == 0) {
+    return bytes;
+  }
+
+  void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    godot::UtilityFunctions::push_error("Unable to map file descriptor: ",
+                                        strerror(errno));
+    return bytes;
+  }
+  bytes.resize(size);
+  memcpy(bytes.ptrw(), data, size);
+  ::munmap(data, size);
+
+  return bytes;
+}
+
+// Reads the file behind the descriptor with pread until its end. The given
+// size is only a hint, the file may shrink or grow while it is read.
+PackedByteArray DBusUnixFd::read_bytes_unsealed(int64_t size_hint) {
+  PackedByteArray bytes = PackedByteArray();
+  bytes.resize(size_hint > 0 ? size_hint : 4096);
+  int64_t offset = 0;
+  while (true) {
+    if (offset == bytes.size()) {
+      bytes.resize(bytes.size() * 2);
+    }
+    ssize_t count = ::pread(fd, bytes.ptrw() + offset, bytes.size() - offset,
+                            offset);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      godot::UtilityFunctions::push_error("Unable to read file descriptor: ",
+                                          strerror(errno));
+      return PackedByteArray();
+    }
+    if (count == 0) {
+      break;
+    }
+    offset += count;
+  }
+  bytes.resize(offset);
+
+  return bytes;
+}
+
+// Returns a new descriptor for an anonymous in-memory file holding the given
+// bytes. The file is sealed so the receiver can map it without having to
+// guard against the sender changing or truncating it afterwards.
+DBusUnixFd *DBusUnixFd::from_bytes(PackedByteArray bytes) {
+  int memfd = ::memfd_create("godot-dbus", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (memfd < 0) {
+    godot::UtilityFunctions::push_error("Unable to create memfd: ",
+                                        strerror(errno));
+    return nullptr;
+  }
+
+  // Write the payload in full, retrying on partial writes
+  const uint8_t *data = bytes.ptr();
+  int64_t remaining = bytes.size();
+  while (remaining > 0) {
+    ssize_t written = ::write(memfd, data, remaining);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      godot::UtilityFunctions::push_error("Unable to write memfd: ",
+                                          strerror(errno));
+      ::close(memfd);
+      return nullptr;
+    }
+    data += written;
+    remaining -= written;
+  }
+
+  int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+  if (::fcntl(memfd, F_ADD_SEALS, seals) != 0) {
+    godot::UtilityFunctions::push_error("Unable to seal memfd: ",
+                                        strerror(errno));
+    ::close(memfd);
+    return nullptr;
+  }
+
+  DBusUnixFd *unix_fd = memnew(DBusUnixFd);
+  unix_fd->set_fd(memfd);
+  return unix_fd;
+}
+
+// Returns the descriptor number, which is what gets marshaled for "h"
+Variant DBusUnixFd::to_variant() { return Variant((int64_t)fd); }
+
+// Register the methods with Godot
+void DBusUnixFd::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_fd", "fd"), &DBusUnixFd::set_fd);
+  ClassDB::bind_method(D_METHOD("get_fd"), &DBusUnixFd::get_fd);
+  ClassDB::bind_method(D_METHOD("is_valid"), &DBusUnixFd::is_valid);
+  ClassDB::bind_method(D_METHOD("detach"), &DBusUnixFd::detach);
+  ClassDB::bind_method(D_METHOD("close"), &DBusUnixFd::close);
+  ClassDB::bind_method(D_METHOD("get_size"), &DBusUnixFd::get_size);
+  ClassDB::bind_method(D_METHOD("read_bytes"), &DBusUnixFd::read_bytes);
+  ClassDB::bind_static_method("DBusUnixFd", D_METHOD("from_bytes", "bytes"),
+                              &DBusUnixFd::from_bytes);
+};
@@ -0,0 +1,42 @@
+#ifndef DBUS_UNIX_FD_CLASS_H
+#define DBUS_UNIX_FD_CLASS_H
+
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include "dbus_types.h"
+
+// Owned unix file descriptor received from or sent over the bus. The
+// descriptor is closed when the object is freed unless it was detached.
+class DBusUnixFd : public DBusType {
+  GDCLASS(DBusUnixFd, DBusType);
+
+protected:
+  static void _bind_methods();
+
+private:
+  int fd = -1;
+
+  godot::PackedByteArray read_bytes_unsealed(int64_t size_hint);
+
+public:
+  // Constructor/deconstructor
+  DBusUnixFd();
+  ~DBusUnixFd();
+
+  // Methods
+  void set_fd(int new_fd);
+  int get_fd();
+  bool is_valid();
+  int detach();
+  void close();
+  int64_t get_size();
+  godot::PackedByteArray read_bytes();
+  godot::Variant to_variant() override;
+
+  // Methods that create descriptors
+  static DBusUnixFd *from_bytes(godot::PackedByteArray bytes);
+};
+
+#endif // DBUS_UNIX_FD_CLASS_H
@@ -7,8 +7,18 @@
 #include <godot_cpp/godot.hpp>
 
 #include "dbus.h"
+#include "dbus_connection_pool.h"
+#include "dbus_event_loop.h"
 #include "dbus_message.h"
+#include "dbus_name_watcher.h"
+#include "dbus_object_manager_mirror.h"
+#include "dbus_pending_call.h"
+#include "dbus_property_cache.h"
+#include "dbus_proxy.h"
+#include "dbus_replay_source.h"
+#include "dbus_signature_plan.h"
 #include "dbus_types.h"
+#include "dbus_unix_fd.h"
 
 void initialize_dbus_module(godot::ModuleInitializationLevel p_level) {
   if (p_level != godot::MODULE_INITIALIZATION_LEVEL_SCENE) {
@@ -16,15 +26,34 @@ void initialize_dbus_module(godot::ModuleInitializationLevel p_level) {
   }
 
   godot::ClassDB::register_class<DBusMessage>();
+  godot::ClassDB::register_class<DBusPendingCall>();
+  godot::ClassDB::register_class<DBusPropertyCache>();
+  godot::ClassDB::register_class<DBusProxy>();
+  godot::ClassDB::register_class<DBusNameWatcher>();
+  godot::ClassDB::register_class<DBusObjectManagerMirror>();
   godot::ClassDB::register_class<DBus>();
+  godot::ClassDB::register_class<DBusConnectionPool>();
+  godot::ClassDB::register_class<DBusEventLoop>();
+  godot::ClassDB::register_class<DBusReplaySource>();
   godot::ClassDB::register_class<DBusType>();
   godot::ClassDB::register_class<DBusUInt32>();
+  godot::ClassDB::register_class<DBusInt16>();
+  godot::ClassDB::register_class<DBusUInt16>();
+  godot::ClassDB::register_class<DBusInt64>();
+  godot::ClassDB::register_class<DBusUInt64>();
+  godot::ClassDB::register_class<DBusByte>();
+  godot::ClassDB::register_class<DBusObjectPath>();
+  godot::ClassDB::register_class<DBusSignature>();
+  godot::ClassDB::register_class<DBusStruct>();
+  godot::ClassDB::register_class<DBusUnixFd>();
 }
 
 void uninitialize_dbus_module(godot::ModuleInitializationLevel p_level) {
   if (p_level != godot::MODULE_INITIALIZATION_LEVEL_SCENE) {
     return;
   }
+
+  DBusSignaturePlan::clear_cache();
 }
 
 extern "C" {
@@ -0,0 +1,59 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. The capacity is rounded up to the next power of two.
+template <typename T> class SPSCQueue {
+private:
+  std::vector<T> buffer;
+  size_t mask;
+  // Head and tail live on separate cache lines so the producer and consumer
+  // do not contend on the same line.
+  alignas(64) std::atomic<size_t> head{0}; // Next slot to read (consumer)
+  alignas(64) std::atomic<size_t> tail{0}; // Next slot to write (producer)
+
+public:
+  explicit SPSCQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    buffer.resize(size);
+    mask = size - 1;
+  }
+
+  // Pushes the given item. Returns false if the queue is full. Producer only.
+  bool push(const T &item) {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == buffer.size()) {
+      return false;
+    }
+    buffer[t & mask] = item;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops the oldest item. Returns false if the queue is empty. Consumer only.
+  bool pop(T &item) {
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = buffer[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns the number of queued items. Only approximate while the other
+  // thread is running.
+  size_t size() const {
+    return tail.load(std::memory_order_acquire) -
+           head.load(std::memory_order_acquire);
+  }
+};
+
+#endif // SPSC_QUEUE_H